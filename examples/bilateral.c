@@ -0,0 +1,24 @@
+#include "example.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+int main(int argc, char* argv[])
+{
+    if(argc != 4) {
+        fprintf(stderr, "Usage: bilateral <input> <spatial_sigma> <range_sigma>\n");
+        return 1;
+    }
+
+    plutofilter_surface_t input = example__load_input(argv[1]);
+    float spatial_sigma = (float)atof(argv[2]);
+    float range_sigma = (float)atof(argv[3]);
+
+    uint32_t* scratch = malloc(plutofilter_bilateral_scratch_size(input.width, input.height, spatial_sigma, range_sigma) * sizeof(uint32_t));
+    plutofilter_bilateral(input, input, spatial_sigma, range_sigma, scratch);
+    free(scratch);
+
+    example__write_output(input, argv[1], NULL, "bilateral-%g-%g", spatial_sigma, range_sigma);
+    return 0;
+}
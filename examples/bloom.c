@@ -0,0 +1,25 @@
+#include "example.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+int main(int argc, char* argv[])
+{
+    if(argc != 5) {
+        fprintf(stderr, "Usage: bloom <input> <threshold> <intensity> <levels>\n");
+        return 1;
+    }
+
+    plutofilter_surface_t input = example__load_input(argv[1]);
+    float threshold = (float)atof(argv[2]);
+    float intensity = (float)atof(argv[3]);
+    int levels = atoi(argv[4]);
+
+    uint32_t* scratch = malloc(PLUTOFILTER_BLOOM_SCRATCH_SIZE(input.width, input.height) * sizeof(uint32_t));
+    plutofilter_bloom(input, input, threshold, intensity, levels, scratch);
+    free(scratch);
+
+    example__write_output(input, argv[1], NULL, "bloom-%g-%g-%d", threshold, intensity, levels);
+    return 0;
+}
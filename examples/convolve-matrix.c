@@ -0,0 +1,66 @@
+#include "example.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+int main(int argc, char* argv[])
+{
+    if(argc != 3) {
+        fprintf(stderr, "Usage: convolve-matrix <input> <sharpen|emboss|outline|gaussian>\n");
+        return 1;
+    }
+
+    static const float sharpen[] = {
+         0.0f, -1.0f,  0.0f,
+        -1.0f,  5.0f, -1.0f,
+         0.0f, -1.0f,  0.0f
+    };
+
+    static const float emboss[] = {
+        -2.0f, -1.0f, 0.0f,
+        -1.0f,  1.0f, 1.0f,
+         0.0f,  1.0f, 2.0f
+    };
+
+    static const float outline[] = {
+        -1.0f, -1.0f, -1.0f,
+        -1.0f,  8.0f, -1.0f,
+        -1.0f, -1.0f, -1.0f
+    };
+
+    static const float gaussian[] = {
+        1.0f,  4.0f,  6.0f,  4.0f, 1.0f,
+        4.0f, 16.0f, 24.0f, 16.0f, 4.0f,
+        6.0f, 24.0f, 36.0f, 24.0f, 6.0f,
+        4.0f, 16.0f, 24.0f, 16.0f, 4.0f,
+        1.0f,  4.0f,  6.0f,  4.0f, 1.0f
+    };
+
+    const float* kernel = NULL;
+    int order = 3;
+    int preserve_alpha = 1;
+    if(strcmp(argv[2], "sharpen") == 0) {
+        kernel = sharpen;
+    } else if(strcmp(argv[2], "emboss") == 0) {
+        kernel = emboss;
+    } else if(strcmp(argv[2], "outline") == 0) {
+        kernel = outline;
+    } else if(strcmp(argv[2], "gaussian") == 0) {
+        kernel = gaussian;
+        order = 5;
+        preserve_alpha = 0;
+    } else {
+        fprintf(stderr, "Unknown kernel: %s\n", argv[2]);
+        return 1;
+    }
+
+    plutofilter_surface_t input = example__load_input(argv[1]);
+    plutofilter_surface_t output = example__load_input(argv[1]);
+
+    plutofilter_convolve_matrix(input, output, order, order, kernel, 0.0f, 0.0f, order / 2, order / 2, PLUTOFILTER_EDGE_MODE_DUPLICATE, preserve_alpha);
+
+    free(input.pixels);
+    example__write_output(output, argv[1], NULL, "convolve-matrix-%s", argv[2]);
+    return 0;
+}
@@ -0,0 +1,52 @@
+#include "example.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+int main(int argc, char* argv[])
+{
+    if(argc != 4) {
+        fprintf(stderr, "Usage: convolve-separable <input> <box|binomial|sharpen> <none|duplicate|wrap>\n");
+        return 1;
+    }
+
+    static const float box[] = { 0.2f, 0.2f, 0.2f, 0.2f, 0.2f };
+    static const float binomial[] = { 0.0625f, 0.25f, 0.375f, 0.25f, 0.0625f };
+    static const float sharpen[] = { -0.5f, 2.0f, -0.5f };
+
+    const float* kernel = NULL;
+    int size = 0;
+    if(strcmp(argv[2], "box") == 0) {
+        kernel = box;
+        size = sizeof(box) / sizeof(box[0]);
+    } else if(strcmp(argv[2], "binomial") == 0) {
+        kernel = binomial;
+        size = sizeof(binomial) / sizeof(binomial[0]);
+    } else if(strcmp(argv[2], "sharpen") == 0) {
+        kernel = sharpen;
+        size = sizeof(sharpen) / sizeof(sharpen[0]);
+    } else {
+        fprintf(stderr, "Unknown kernel: %s\n", argv[2]);
+        return 1;
+    }
+
+    plutofilter_edge_mode_t edge_mode;
+    if(strcmp(argv[3], "none") == 0) {
+        edge_mode = PLUTOFILTER_EDGE_MODE_NONE;
+    } else if(strcmp(argv[3], "duplicate") == 0) {
+        edge_mode = PLUTOFILTER_EDGE_MODE_DUPLICATE;
+    } else if(strcmp(argv[3], "wrap") == 0) {
+        edge_mode = PLUTOFILTER_EDGE_MODE_WRAP;
+    } else {
+        fprintf(stderr, "Unknown edge mode: %s\n", argv[3]);
+        return 1;
+    }
+
+    plutofilter_surface_t input = example__load_input(argv[1]);
+
+    plutofilter_convolve_separable(input, input, kernel, size, kernel, size, edge_mode);
+
+    example__write_output(input, argv[1], NULL, "convolve-separable-%s-%s", argv[2], argv[3]);
+    return 0;
+}
@@ -0,0 +1,26 @@
+#include "example.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+int main(int argc, char* argv[])
+{
+    if(argc != 4) {
+        fprintf(stderr, "Usage: displacement-map <input> <scale> <base_frequency>\n");
+        return 1;
+    }
+
+    plutofilter_surface_t input = example__load_input(argv[1]);
+    float scale = (float)atof(argv[2]);
+    float base_frequency = (float)atof(argv[3]);
+
+    // Displace by fractal noise, as for a rippling water or heat-haze effect.
+    plutofilter_surface_t output = plutofilter_surface_make(malloc(input.width * input.height * sizeof(uint32_t)), input.width, input.height, input.width);
+    plutofilter_turbulence(output, base_frequency, base_frequency, 2, 0, 0, PLUTOFILTER_TURBULENCE_TYPE_FRACTAL_NOISE);
+    plutofilter_displacement_map(input, output, output, scale, PLUTOFILTER_CHANNEL_R, PLUTOFILTER_CHANNEL_G);
+    free(input.pixels);
+
+    example__write_output(output, argv[1], NULL, "displacement-map-%g-%g", scale, base_frequency);
+    return 0;
+}
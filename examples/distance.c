@@ -0,0 +1,32 @@
+#include "example.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+int main(int argc, char* argv[])
+{
+    if(argc != 4) {
+        fprintf(stderr, "Usage: distance <input> <transform|outline|glow> <amount>\n");
+        return 1;
+    }
+
+    plutofilter_surface_t input = example__load_input(argv[1]);
+    plutofilter_surface_t output = example__load_input(argv[1]);
+    float amount = (float)atof(argv[3]);
+
+    if(strcmp(argv[2], "transform") == 0) {
+        plutofilter_distance_transform(input, output, amount);
+    } else if(strcmp(argv[2], "outline") == 0) {
+        plutofilter_distance_outline(input, output, amount);
+    } else if(strcmp(argv[2], "glow") == 0) {
+        plutofilter_distance_glow(input, output, amount);
+    } else {
+        fprintf(stderr, "Unknown mode: %s\n", argv[2]);
+        return 1;
+    }
+
+    free(input.pixels);
+    example__write_output(output, argv[1], NULL, "distance-%s-%g", argv[2], amount);
+    return 0;
+}
@@ -0,0 +1,82 @@
+#include "example.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+int main(int argc, char* argv[])
+{
+    if(argc != 3 && argc != 4) {
+        fprintf(stderr, "Usage: dither <input> <none|ordered|floyd-steinberg> [spikes]\n");
+        return 1;
+    }
+
+    if(argc == 4 && strcmp(argv[3], "spikes") != 0) {
+        fprintf(stderr, "Invalid option: %s\n", argv[3]);
+        return 1;
+    }
+
+    plutofilter_dither_t dither;
+    if(strcmp(argv[2], "none") == 0) {
+        dither = PLUTOFILTER_DITHER_NONE;
+    } else if(strcmp(argv[2], "ordered") == 0) {
+        dither = PLUTOFILTER_DITHER_ORDERED;
+    } else if(strcmp(argv[2], "floyd-steinberg") == 0) {
+        dither = PLUTOFILTER_DITHER_FLOYD_STEINBERG;
+    } else {
+        fprintf(stderr, "Invalid dither mode: %s\n", argv[2]);
+        return 1;
+    }
+
+    plutofilter_surface_t input = example__load_input(argv[1]);
+
+    float* pixels = malloc(sizeof(float) * 4 * input.width * input.height);
+    if(pixels == NULL) {
+        fprintf(stderr, "Out of memory\n");
+        return 1;
+    }
+
+    plutofilter_float_surface_t floats = plutofilter_float_surface_make(pixels, input.width, input.height, input.width);
+
+    // Darken the input eight times in float, so that quantizing leaves only 32 levels.
+    for(int y = 0; y < input.height; y++) {
+        for(int x = 0; x < input.width; x++) {
+            const uint32_t pixel = input.pixels[y * input.stride + x];
+            float* value = floats.pixels + (y * floats.stride + x) * 4;
+            value[0] = ((pixel >> 16) & 0xFF) / (255.f * 8.f);
+            value[1] = ((pixel >> 8) & 0xFF) / (255.f * 8.f);
+            value[2] = (pixel & 0xFF) / (255.f * 8.f);
+            value[3] = (pixel >> 24) / 255.f;
+        }
+    }
+
+    // Scatter out-of-range values, which must clip without spreading into their neighbours.
+    if(argc == 4) {
+        for(int y = 16; y < input.height; y += 32) {
+            for(int x = 16; x < input.width; x += 32) {
+                float* value = floats.pixels + (y * floats.stride + x) * 4;
+                value[0] = value[1] = value[2] = (x + y) % 64 ? 50.f : -50.f;
+            }
+        }
+    }
+
+    float* scratch = malloc(sizeof(float) * PLUTOFILTER_QUANTIZE_SCRATCH_SIZE(input.width));
+    if(scratch == NULL) {
+        fprintf(stderr, "Out of memory\n");
+        return 1;
+    }
+
+    plutofilter_quantize(floats, input, dither, scratch);
+    free(scratch);
+    free(pixels);
+
+    // Brighten it back up to make the banding visible.
+    plutofilter_color_transform_brightness(input, input, 8.f);
+
+    if(argc == 4) {
+        example__write_output(input, argv[1], NULL, "dither-%s-%s", argv[2], argv[3]);
+    } else {
+        example__write_output(input, argv[1], NULL, "dither-%s", argv[2]);
+    }
+    return 0;
+}
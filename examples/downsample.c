@@ -0,0 +1,59 @@
+#include "example.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define MAX_LEVELS 8
+
+int main(int argc, char* argv[])
+{
+    if(argc != 5) {
+        fprintf(stderr, "Usage: downsample <input> <box|tent> <srgb|linear> <levels>\n");
+        return 1;
+    }
+
+    plutofilter_surface_t input = example__load_input(argv[1]);
+    int count = atoi(argv[4]);
+    if(count < 1 || count > MAX_LEVELS) {
+        fprintf(stderr, "Levels must be between 1 and %d\n", MAX_LEVELS);
+        return 1;
+    }
+
+    plutofilter_downsample_filter_t filter;
+    if(strcmp(argv[2], "box") == 0) {
+        filter = PLUTOFILTER_DOWNSAMPLE_FILTER_BOX;
+    } else if(strcmp(argv[2], "tent") == 0) {
+        filter = PLUTOFILTER_DOWNSAMPLE_FILTER_TENT;
+    } else {
+        fprintf(stderr, "Unknown filter: %s\n", argv[2]);
+        return 1;
+    }
+
+    plutofilter_color_space_t color_space;
+    if(strcmp(argv[3], "srgb") == 0) {
+        color_space = PLUTOFILTER_COLOR_SPACE_SRGB;
+    } else if(strcmp(argv[3], "linear") == 0) {
+        color_space = PLUTOFILTER_COLOR_SPACE_LINEAR_RGB;
+    } else {
+        fprintf(stderr, "Unknown color space: %s\n", argv[3]);
+        return 1;
+    }
+
+    plutofilter_surface_t levels[MAX_LEVELS];
+    int width = input.width;
+    int height = input.height;
+    for(int i = 0; i < count; i++) {
+        width = (width + 1) / 2;
+        height = (height + 1) / 2;
+        levels[i] = plutofilter_surface_make(malloc(width * height * sizeof(uint32_t)), width, height, width);
+    }
+
+    plutofilter_downsample_chain(input, levels, count, filter, color_space);
+    free(input.pixels);
+
+    example__write_output(levels[count - 1], argv[1], NULL, "downsample-%s-%s-%d", argv[2], argv[3], count);
+    for(int i = 0; i < count - 1; i++)
+        free(levels[i].pixels);
+    return 0;
+}
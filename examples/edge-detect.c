@@ -0,0 +1,32 @@
+#include "example.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+int main(int argc, char* argv[])
+{
+    if(argc != 3) {
+        fprintf(stderr, "Usage: edge-detect <input> <sobel|scharr>\n");
+        return 1;
+    }
+
+    plutofilter_surface_t input = example__load_input(argv[1]);
+
+    plutofilter_edge_operator_t op;
+    if(strcmp(argv[2], "sobel") == 0) {
+        op = PLUTOFILTER_EDGE_OPERATOR_SOBEL;
+    } else if(strcmp(argv[2], "scharr") == 0) {
+        op = PLUTOFILTER_EDGE_OPERATOR_SCHARR;
+    } else {
+        fprintf(stderr, "Invalid edge operator: %s\n", argv[2]);
+        return 1;
+    }
+
+    plutofilter_surface_t output = plutofilter_surface_make(malloc(input.width * input.height * sizeof(uint32_t)), input.width, input.height, input.width);
+    plutofilter_edge_detect(input, output, op);
+    free(input.pixels);
+
+    example__write_output(output, argv[1], NULL, "edge-detect-%s", argv[2]);
+    return 0;
+}
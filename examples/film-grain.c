@@ -0,0 +1,29 @@
+#include "example.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+int main(int argc, char* argv[])
+{
+    if(argc != 4) {
+        fprintf(stderr, "Usage: film-grain <input> <amount> <monochrome|color>\n");
+        return 1;
+    }
+
+    int monochrome;
+    if(strcmp(argv[3], "monochrome") == 0) {
+        monochrome = 1;
+    } else if(strcmp(argv[3], "color") == 0) {
+        monochrome = 0;
+    } else {
+        fprintf(stderr, "Invalid grain type: %s\n", argv[3]);
+        return 1;
+    }
+
+    plutofilter_surface_t input = example__load_input(argv[1]);
+    plutofilter_film_grain(input, input, strtof(argv[2], NULL), 1, 0, monochrome);
+
+    example__write_output(input, argv[1], NULL, "film-grain-%s-%s", argv[2], argv[3]);
+    return 0;
+}
@@ -0,0 +1,39 @@
+#include "example.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define MAX_STOPS 8
+
+int main(int argc, char* argv[])
+{
+    if(argc < 4 || argc > 2 + MAX_STOPS) {
+        fprintf(stderr, "Usage: gradient-map <input> <rrggbb> <rrggbb> [rrggbb...]\n");
+        return 1;
+    }
+
+    uint32_t colors[MAX_STOPS];
+    char name[7 * MAX_STOPS] = "";
+    for(int i = 2; i < argc; i++) {
+        char* end;
+        colors[i - 2] = 0xFF000000 | (uint32_t)strtoul(argv[i], &end, 16);
+        if(*end || strlen(argv[i]) != 6) {
+            fprintf(stderr, "Invalid color: %s\n", argv[i]);
+            return 1;
+        }
+
+        if(i > 2)
+            strcat(name, "-");
+        strcat(name, argv[i]);
+    }
+
+    plutofilter_surface_t input = example__load_input(argv[1]);
+
+    uint32_t ramp[256];
+    plutofilter_gradient_ramp(ramp, colors, argc - 2);
+    plutofilter_gradient_map(input, input, ramp);
+
+    example__write_output(input, argv[1], NULL, "gradient-map-%s", name);
+    return 0;
+}
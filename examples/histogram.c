@@ -0,0 +1,54 @@
+#include "example.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+int main(int argc, char* argv[])
+{
+    if(argc != 2) {
+        fprintf(stderr, "Usage: histogram <input>\n");
+        return 1;
+    }
+
+    plutofilter_surface_t input = example__load_input(argv[1]);
+
+    plutofilter_stats_t stats;
+    plutofilter_stats(input, &stats, 1);
+
+    static const char* names[4] = {"red", "green", "blue", "alpha"};
+    for(int channel = 0; channel < 4; channel++) {
+        printf("%-5s min %3d max %3d mean %6.2f standard deviation %6.2f\n", names[channel],
+               stats.min[channel], stats.max[channel], stats.mean[channel], stats.standard_deviation[channel]);
+    }
+
+    plutofilter_histogram_t histogram;
+    plutofilter_histogram(input, &histogram, 1);
+    free(input.pixels);
+
+    // Plot the red, green and blue histograms over each other, scaled to the tallest bin.
+    const int width = 256;
+    const int height = 128;
+    uint32_t peak = 1;
+    for(int channel = PLUTOFILTER_CHANNEL_R; channel <= PLUTOFILTER_CHANNEL_B; channel++) {
+        for(int value = 0; value < 256; value++) {
+            if(histogram.counts[channel][value] > peak) {
+                peak = histogram.counts[channel][value];
+            }
+        }
+    }
+
+    plutofilter_surface_t output = plutofilter_surface_make(malloc(width * height * sizeof(uint32_t)), width, height, width);
+    for(int x = 0; x < width; x++) {
+        const int r = (int)((uint64_t)histogram.counts[PLUTOFILTER_CHANNEL_R][x] * height / peak);
+        const int g = (int)((uint64_t)histogram.counts[PLUTOFILTER_CHANNEL_G][x] * height / peak);
+        const int b = (int)((uint64_t)histogram.counts[PLUTOFILTER_CHANNEL_B][x] * height / peak);
+        for(int y = 0; y < height; y++) {
+            const int level = height - y;
+            output.pixels[y * width + x] = 0xFF000000 | (level <= r ? 0xFF0000 : 0) | (level <= g ? 0x00FF00 : 0) | (level <= b ? 0x0000FF : 0);
+        }
+    }
+
+    example__write_output(output, argv[1], NULL, "histogram");
+    return 0;
+}
@@ -0,0 +1,30 @@
+#include "example.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+int main(int argc, char* argv[])
+{
+    if(argc != 3) {
+        fprintf(stderr, "Usage: levels <input> <none|auto|equalize>\n");
+        return 1;
+    }
+
+    plutofilter_surface_t input = example__load_input(argv[1]);
+
+    // Wash out the input first, so there is a narrow range to correct.
+    plutofilter_color_transform_contrast(input, input, 0.4f);
+
+    if(strcmp(argv[2], "auto") == 0) {
+        plutofilter_auto_levels(input, input, 0.005f);
+    } else if(strcmp(argv[2], "equalize") == 0) {
+        plutofilter_equalize(input, input);
+    } else if(strcmp(argv[2], "none") != 0) {
+        fprintf(stderr, "Invalid levels mode: %s\n", argv[2]);
+        return 1;
+    }
+
+    example__write_output(input, argv[1], NULL, "levels-%s", argv[2]);
+    return 0;
+}
@@ -0,0 +1,59 @@
+#include "example.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+int main(int argc, char* argv[])
+{
+    if(argc != 4) {
+        fprintf(stderr, "Usage: lighting <input> <diffuse|specular> <distant|point|spot>\n");
+        return 1;
+    }
+
+    plutofilter_surface_t input = example__load_input(argv[1]);
+
+    plutofilter_light_source_t light = {0};
+    light.specular_exponent = 1.f;
+    light.limiting_cone_angle = 90.f;
+    if(strcmp(argv[3], "distant") == 0) {
+        light.type = PLUTOFILTER_LIGHT_TYPE_DISTANT;
+        light.azimuth = 225.f;
+        light.elevation = 45.f;
+    } else if(strcmp(argv[3], "point") == 0) {
+        light.type = PLUTOFILTER_LIGHT_TYPE_POINT;
+        light.x = input.width * 0.25f;
+        light.y = input.height * 0.25f;
+        light.z = input.width * 0.5f;
+    } else if(strcmp(argv[3], "spot") == 0) {
+        light.type = PLUTOFILTER_LIGHT_TYPE_SPOT;
+        light.x = 0.f;
+        light.y = 0.f;
+        light.z = input.width * 0.75f;
+        light.points_at_x = input.width * 0.5f;
+        light.points_at_y = input.height * 0.5f;
+        light.specular_exponent = 8.f;
+        light.limiting_cone_angle = 30.f;
+    } else {
+        fprintf(stderr, "Invalid light type: %s\n", argv[3]);
+        return 1;
+    }
+
+    // Soften the alpha channel first, so the edges light as a rounded bevel.
+    plutofilter_gaussian_blur(input, input, 4.f, 4.f);
+
+    plutofilter_surface_t output = plutofilter_surface_make(malloc(input.width * input.height * sizeof(uint32_t)), input.width, input.height, input.width);
+    if(strcmp(argv[2], "diffuse") == 0) {
+        plutofilter_diffuse_lighting(input, output, 10.f, 1.f, 0xFFFFFFFF, &light);
+    } else if(strcmp(argv[2], "specular") == 0) {
+        plutofilter_specular_lighting(input, output, 10.f, 1.f, 20.f, 0xFFFFFFFF, &light);
+    } else {
+        fprintf(stderr, "Invalid lighting type: %s\n", argv[2]);
+        return 1;
+    }
+
+    free(input.pixels);
+
+    example__write_output(output, argv[1], NULL, "lighting-%s-%s", argv[2], argv[3]);
+    return 0;
+}
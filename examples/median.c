@@ -0,0 +1,23 @@
+#include "example.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+int main(int argc, char* argv[])
+{
+    if(argc != 3) {
+        fprintf(stderr, "Usage: median <input> <radius>\n");
+        return 1;
+    }
+
+    plutofilter_surface_t input = example__load_input(argv[1]);
+    int radius = atoi(argv[2]);
+
+    plutofilter_surface_t output = plutofilter_surface_make(malloc(input.width * input.height * sizeof(uint32_t)), input.width, input.height, input.width);
+    plutofilter_median(input, output, radius);
+    free(input.pixels);
+
+    example__write_output(output, argv[1], NULL, "median-%d", radius);
+    return 0;
+}
@@ -0,0 +1,32 @@
+#include "example.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+int main(int argc, char* argv[])
+{
+    if(argc != 4 && argc != 5) {
+        fprintf(stderr, "Usage: morphology <input> <erode|dilate> <radius-x> [radius-y]\n");
+        return 1;
+    }
+
+    plutofilter_morphology_operator_t op;
+    if(strcmp(argv[2], "erode") == 0) {
+        op = PLUTOFILTER_MORPHOLOGY_OPERATOR_ERODE;
+    } else if(strcmp(argv[2], "dilate") == 0) {
+        op = PLUTOFILTER_MORPHOLOGY_OPERATOR_DILATE;
+    } else {
+        fprintf(stderr, "Unknown operator: %s\n", argv[2]);
+        return 1;
+    }
+
+    plutofilter_surface_t input = example__load_input(argv[1]);
+    int radius_x = atoi(argv[3]);
+    int radius_y = (argc == 5) ? atoi(argv[4]) : radius_x;
+
+    plutofilter_morphology(input, input, op, radius_x, radius_y);
+
+    example__write_output(input, argv[1], NULL, "morphology-%s-%d-%d", argv[2], radius_x, radius_y);
+    return 0;
+}
@@ -0,0 +1,29 @@
+#include "example.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+int main(int argc, char* argv[])
+{
+    if(argc != 5) {
+        fprintf(stderr, "Usage: motion-blur <input> <box|gaussian> <angle> <amount>\n");
+        return 1;
+    }
+
+    plutofilter_surface_t input = example__load_input(argv[1]);
+    float angle = (float)atof(argv[3]);
+    float amount = (float)atof(argv[4]);
+
+    if(strcmp(argv[2], "box") == 0) {
+        plutofilter_motion_blur(input, input, angle, amount);
+    } else if(strcmp(argv[2], "gaussian") == 0) {
+        plutofilter_directional_blur(input, input, angle, amount);
+    } else {
+        fprintf(stderr, "Unknown filter: %s\n", argv[2]);
+        return 1;
+    }
+
+    example__write_output(input, argv[1], NULL, "motion-blur-%s-%g-%g", argv[2], angle, amount);
+    return 0;
+}
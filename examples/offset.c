@@ -0,0 +1,30 @@
+#include "example.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+int main(int argc, char* argv[])
+{
+    if(argc != 5) {
+        fprintf(stderr, "Usage: offset <input> <dx> <dy> <std_deviation>\n");
+        return 1;
+    }
+
+    plutofilter_surface_t input = example__load_input(argv[1]);
+    int dx = atoi(argv[2]);
+    int dy = atoi(argv[3]);
+    float std_deviation = (float)atof(argv[4]);
+
+    // Build a drop shadow: flood, clip to the input's alpha, offset, blur, and draw the input over it.
+    plutofilter_surface_t output = plutofilter_surface_make(malloc(input.width * input.height * sizeof(uint32_t)), input.width, input.height, input.width);
+    plutofilter_flood(output, 0x99000000);
+    plutofilter_composite(output, input, output, PLUTOFILTER_COMPOSITE_OPERATOR_IN);
+    plutofilter_offset(output, output, dx, dy);
+    plutofilter_gaussian_blur(output, output, std_deviation, std_deviation);
+    plutofilter_composite(input, output, output, PLUTOFILTER_COMPOSITE_OPERATOR_OVER);
+    free(input.pixels);
+
+    example__write_output(output, argv[1], NULL, "offset-%d-%d-%g", dx, dy, std_deviation);
+    return 0;
+}
@@ -0,0 +1,40 @@
+#include "example.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+int main(int argc, char* argv[])
+{
+    if(argc != 5) {
+        fprintf(stderr, "Usage: resize <input> <bilinear|bicubic|lanczos> <width> <height>\n");
+        return 1;
+    }
+
+    plutofilter_surface_t input = example__load_input(argv[1]);
+    int width = atoi(argv[3]);
+    int height = atoi(argv[4]);
+    if(width <= 0 || height <= 0 || width > 65535 || height > 65535) {
+        fprintf(stderr, "Invalid size: %sx%s\n", argv[3], argv[4]);
+        return 1;
+    }
+
+    plutofilter_resample_filter_t filter;
+    if(strcmp(argv[2], "bilinear") == 0) {
+        filter = PLUTOFILTER_RESAMPLE_FILTER_BILINEAR;
+    } else if(strcmp(argv[2], "bicubic") == 0) {
+        filter = PLUTOFILTER_RESAMPLE_FILTER_BICUBIC;
+    } else if(strcmp(argv[2], "lanczos") == 0) {
+        filter = PLUTOFILTER_RESAMPLE_FILTER_LANCZOS;
+    } else {
+        fprintf(stderr, "Unknown filter: %s\n", argv[2]);
+        return 1;
+    }
+
+    plutofilter_surface_t output = plutofilter_surface_make(malloc(width * height * sizeof(uint32_t)), width, height, width);
+    plutofilter_resize(input, output, filter);
+    free(input.pixels);
+
+    example__write_output(output, argv[1], NULL, "resize-%s-%dx%d", argv[2], width, height);
+    return 0;
+}
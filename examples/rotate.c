@@ -0,0 +1,40 @@
+#include "example.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+int main(int argc, char* argv[])
+{
+    if(argc != 3) {
+        fprintf(stderr, "Usage: rotate <input> <90|180|270|horizontal|vertical|transpose>\n");
+        return 1;
+    }
+
+    plutofilter_surface_t input = example__load_input(argv[1]);
+    plutofilter_surface_t output = plutofilter_surface_make(malloc(input.width * input.height * sizeof(uint32_t)), input.height, input.width, input.height);
+
+    if(strcmp(argv[2], "90") == 0) {
+        plutofilter_rotate(input, output, PLUTOFILTER_ROTATION_90);
+    } else if(strcmp(argv[2], "270") == 0) {
+        plutofilter_rotate(input, output, PLUTOFILTER_ROTATION_270);
+    } else if(strcmp(argv[2], "transpose") == 0) {
+        plutofilter_transpose(input, output);
+    } else {
+        output = plutofilter_surface_make(output.pixels, input.width, input.height, input.width);
+        if(strcmp(argv[2], "180") == 0) {
+            plutofilter_rotate(input, output, PLUTOFILTER_ROTATION_180);
+        } else if(strcmp(argv[2], "horizontal") == 0) {
+            plutofilter_flip(input, output, PLUTOFILTER_FLIP_HORIZONTAL);
+        } else if(strcmp(argv[2], "vertical") == 0) {
+            plutofilter_flip(input, output, PLUTOFILTER_FLIP_VERTICAL);
+        } else {
+            fprintf(stderr, "Unknown operation: %s\n", argv[2]);
+            return 1;
+        }
+    }
+
+    free(input.pixels);
+    example__write_output(output, argv[1], NULL, "rotate-%s", argv[2]);
+    return 0;
+}
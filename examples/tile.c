@@ -0,0 +1,28 @@
+#include "example.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+int main(int argc, char* argv[])
+{
+    if(argc != 6) {
+        fprintf(stderr, "Usage: tile <input> <x> <y> <width> <height>\n");
+        return 1;
+    }
+
+    plutofilter_surface_t input = example__load_input(argv[1]);
+    int x = atoi(argv[2]);
+    int y = atoi(argv[3]);
+    int width = atoi(argv[4]);
+    int height = atoi(argv[5]);
+
+    // Repeat a region of the input across a surface of the same size, keeping the region in place.
+    plutofilter_surface_t tile = plutofilter_surface_make_sub(input, x, y, width, height);
+    plutofilter_surface_t output = plutofilter_surface_make(malloc(input.width * input.height * sizeof(uint32_t)), input.width, input.height, input.width);
+    plutofilter_tile(tile, output, x, y);
+    free(input.pixels);
+
+    example__write_output(output, argv[1], NULL, "tile-%d-%d-%d-%d", x, y, width, height);
+    return 0;
+}
@@ -0,0 +1,68 @@
+#include "example.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+int main(int argc, char* argv[])
+{
+    if(argc != 4) {
+        fprintf(stderr, "Usage: tone-map <input> <none|reinhard|aces|hable> <exposure>\n");
+        return 1;
+    }
+
+    plutofilter_tone_map_t tone_map;
+    if(strcmp(argv[2], "none") == 0) {
+        tone_map = PLUTOFILTER_TONE_MAP_NONE;
+    } else if(strcmp(argv[2], "reinhard") == 0) {
+        tone_map = PLUTOFILTER_TONE_MAP_REINHARD;
+    } else if(strcmp(argv[2], "aces") == 0) {
+        tone_map = PLUTOFILTER_TONE_MAP_ACES;
+    } else if(strcmp(argv[2], "hable") == 0) {
+        tone_map = PLUTOFILTER_TONE_MAP_HABLE;
+    } else {
+        fprintf(stderr, "Invalid tone map: %s\n", argv[2]);
+        return 1;
+    }
+
+    plutofilter_surface_t input = example__load_input(argv[1]);
+
+    float* pixels = malloc(sizeof(float) * 4 * input.width * input.height);
+    if(pixels == NULL) {
+        fprintf(stderr, "Out of memory\n");
+        return 1;
+    }
+
+    plutofilter_float_surface_t floats = plutofilter_float_surface_make(pixels, input.width, input.height, input.width);
+
+    // Decode the input to linear RGB floats.
+    float decode[256];
+    for(int i = 0; i < 256; i++) {
+        const float c = i / 255.f;
+        decode[i] = c <= 0.04045f ? c / 12.92f : powf((c + 0.055f) / 1.055f, 2.4f);
+    }
+
+    for(int y = 0; y < input.height; y++) {
+        for(int x = 0; x < input.width; x++) {
+            const uint32_t pixel = input.pixels[y * input.stride + x];
+            const uint32_t a = pixel >> 24;
+            float* value = floats.pixels + (y * floats.stride + x) * 4;
+            value[3] = a / 255.f;
+            if(a == 0) {
+                value[0] = value[1] = value[2] = 0.f;
+                continue;
+            }
+
+            value[0] = decode[255 * ((pixel >> 16) & 0xFF) / a] * value[3];
+            value[1] = decode[255 * ((pixel >> 8) & 0xFF) / a] * value[3];
+            value[2] = decode[255 * (pixel & 0xFF) / a] * value[3];
+        }
+    }
+
+    plutofilter_tone_map(floats, input, tone_map, strtof(argv[3], NULL));
+    free(pixels);
+
+    example__write_output(input, argv[1], NULL, "tone-map-%s-%s", argv[2], argv[3]);
+    return 0;
+}
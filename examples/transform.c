@@ -0,0 +1,45 @@
+#include "example.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+int main(int argc, char* argv[])
+{
+    if(argc != 5) {
+        fprintf(stderr, "Usage: transform <input> <bilinear|bicubic|lanczos> <angle> <scale>\n");
+        return 1;
+    }
+
+    plutofilter_surface_t input = example__load_input(argv[1]);
+    float angle = (float)atof(argv[3]);
+    float scale = (float)atof(argv[4]);
+
+    plutofilter_resample_filter_t filter;
+    if(strcmp(argv[2], "bilinear") == 0) {
+        filter = PLUTOFILTER_RESAMPLE_FILTER_BILINEAR;
+    } else if(strcmp(argv[2], "bicubic") == 0) {
+        filter = PLUTOFILTER_RESAMPLE_FILTER_BICUBIC;
+    } else if(strcmp(argv[2], "lanczos") == 0) {
+        filter = PLUTOFILTER_RESAMPLE_FILTER_LANCZOS;
+    } else {
+        fprintf(stderr, "Unknown filter: %s\n", argv[2]);
+        return 1;
+    }
+
+    // Rotate and scale about the center of the surface.
+    float radians = angle * 3.14159265358979323846f / 180.f;
+    float cx = input.width * 0.5f;
+    float cy = input.height * 0.5f;
+    float a = scale * cosf(radians);
+    float b = scale * sinf(radians);
+    float matrix[6] = {a, b, -b, a, cx - a * cx + b * cy, cy - b * cx - a * cy};
+
+    plutofilter_surface_t output = plutofilter_surface_make(malloc(input.width * input.height * sizeof(uint32_t)), input.width, input.height, input.width);
+    plutofilter_transform(input, output, matrix, filter);
+    free(input.pixels);
+
+    example__write_output(output, argv[1], NULL, "transform-%s-%g-%g", argv[2], angle, scale);
+    return 0;
+}
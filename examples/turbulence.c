@@ -0,0 +1,33 @@
+#include "example.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+int main(int argc, char* argv[])
+{
+    if(argc != 5) {
+        fprintf(stderr, "Usage: turbulence <input> <fractal-noise|turbulence> <base_frequency> <num_octaves>\n");
+        return 1;
+    }
+
+    plutofilter_surface_t input = example__load_input(argv[1]);
+    float base_frequency = (float)atof(argv[3]);
+    int num_octaves = atoi(argv[4]);
+
+    plutofilter_turbulence_type_t type;
+    if(strcmp(argv[2], "fractal-noise") == 0) {
+        type = PLUTOFILTER_TURBULENCE_TYPE_FRACTAL_NOISE;
+    } else if(strcmp(argv[2], "turbulence") == 0) {
+        type = PLUTOFILTER_TURBULENCE_TYPE_TURBULENCE;
+    } else {
+        fprintf(stderr, "Unknown type: %s\n", argv[2]);
+        return 1;
+    }
+
+    // The input only provides the size of the generated noise.
+    plutofilter_turbulence(input, base_frequency, base_frequency, num_octaves, 0, 0, type);
+
+    example__write_output(input, argv[1], NULL, "turbulence-%s-%g-%d", argv[2], base_frequency, num_octaves);
+    return 0;
+}
@@ -0,0 +1,25 @@
+#include "example.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+int main(int argc, char* argv[])
+{
+    if(argc != 5) {
+        fprintf(stderr, "Usage: unsharp-mask <input> <std_deviation> <amount> <threshold>\n");
+        return 1;
+    }
+
+    plutofilter_surface_t input = example__load_input(argv[1]);
+    float std_deviation = (float)atof(argv[2]);
+    float amount = (float)atof(argv[3]);
+    float threshold = (float)atof(argv[4]);
+
+    plutofilter_surface_t output = plutofilter_surface_make(malloc(input.width * input.height * sizeof(uint32_t)), input.width, input.height, input.width);
+    plutofilter_unsharp_mask(input, output, std_deviation, amount, threshold);
+    free(input.pixels);
+
+    example__write_output(output, argv[1], NULL, "unsharp-mask-%g-%g-%g", std_deviation, amount, threshold);
+    return 0;
+}
@@ -0,0 +1,47 @@
+#include "example.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+int main(int argc, char* argv[])
+{
+    if(argc != 4) {
+        fprintf(stderr, "Usage: variable-blur <input> <box|tent> <max_radius>\n");
+        return 1;
+    }
+
+    plutofilter_surface_t input = example__load_input(argv[1]);
+    float max_radius = (float)atof(argv[3]);
+
+    plutofilter_variable_blur_filter_t filter;
+    if(strcmp(argv[2], "box") == 0) {
+        filter = PLUTOFILTER_VARIABLE_BLUR_FILTER_BOX;
+    } else if(strcmp(argv[2], "tent") == 0) {
+        filter = PLUTOFILTER_VARIABLE_BLUR_FILTER_TENT;
+    } else {
+        fprintf(stderr, "Unknown filter: %s\n", argv[2]);
+        return 1;
+    }
+
+    // Tilt-shift: sharp along the horizontal center line, blurrier toward the top and bottom edges.
+    plutofilter_surface_t radius_map = input;
+    radius_map.pixels = malloc(input.width * input.height * sizeof(uint32_t));
+    radius_map.stride = input.width;
+    for(int y = 0; y < input.height; y++) {
+        float distance = fabsf(2.f * y / (input.height - 1) - 1.f);
+        uint32_t alpha = (uint32_t)(distance * 255.f + 0.5f);
+        for(int x = 0; x < input.width; x++) {
+            radius_map.pixels[y * radius_map.stride + x] = alpha << 24;
+        }
+    }
+
+    uint32_t* table = malloc(PLUTOFILTER_SUMMED_AREA_TABLE_SIZE(input.width, input.height) * sizeof(uint32_t));
+    plutofilter_variable_blur(input, radius_map, input, max_radius, filter, table);
+    free(radius_map.pixels);
+    free(table);
+
+    example__write_output(input, argv[1], NULL, "variable-blur-%s-%g", argv[2], max_radius);
+    return 0;
+}
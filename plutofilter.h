@@ -23,6 +23,7 @@
 #ifndef PLUTOFILTER_H
 #define PLUTOFILTER_H
 
+#include <stddef.h>
 #include <stdint.h>
 
 #define PLUTOFILTER_VERSION 1
@@ -97,6 +98,53 @@ plutofilter_surface_t plutofilter_surface_make(uint32_t* pixels, uint16_t width,
  */
 plutofilter_surface_t plutofilter_surface_make_sub(plutofilter_surface_t surface, uint16_t x, uint16_t y, uint16_t width, uint16_t height);
 
+/**
+ * @brief Represents a 2D image surface of floating-point RGBA pixels.
+ *
+ * Each pixel is four consecutive floats ordered as red, green, blue and alpha, matching plutofilter_channel_t.
+ * The color channels are premultiplied by alpha. A channel value of 1 is full intensity, and color values
+ * above 1 are allowed for high dynamic range. Filter chains that need more than 8 bits of precision work on
+ * these surfaces and convert to ARGB32 once at the end.
+ *
+ * The pixel data is stored in row-major order. Each row begins at a multiple of `stride` pixels.
+ */
+typedef struct {
+    /**
+     * @brief Pointer to the pixel buffer.
+     *
+     * Must point to at least `4 * stride * height` floats.
+     */
+    float* pixels;
+
+    /**
+     * @brief The width of the surface in pixels.
+     */
+    uint16_t width;
+
+    /**
+     * @brief The height of the surface in pixels.
+     */
+    uint16_t height;
+
+    /**
+     * @brief The number of pixels per row.
+     *
+     * Must be greater than or equal to `width`.
+     */
+    uint32_t stride;
+} plutofilter_float_surface_t;
+
+/**
+ * @brief Creates a floating-point surface from a raw pixel buffer.
+ *
+ * @param pixels Pointer to the pixel buffer of premultiplied RGBA floats.
+ * @param width The width of the surface in pixels.
+ * @param height The height of the surface in pixels.
+ * @param stride The number of pixels per row (must be greater than or equal to width).
+ * @return A plutofilter_float_surface_t representing the given pixel buffer.
+ */
+plutofilter_float_surface_t plutofilter_float_surface_make(float* pixels, uint16_t width, uint16_t height, uint32_t stride);
+
 /**
  * @brief Applies a 5x4 color transformation matrix to each pixel in the input surface.
  * 
@@ -252,6 +300,19 @@ PLUTOFILTER_API void plutofilter_color_transform_srgb_to_linear_rgb(plutofilter_
  */
 PLUTOFILTER_API void plutofilter_color_transform_linear_rgb_to_srgb(plutofilter_surface_t in, plutofilter_surface_t out);
 
+/**
+ * @brief Maps each channel through a lookup table.
+ * 
+ * Each unpremultiplied channel value `v` is replaced by `tables[channel][v]`, with the tables indexed by
+ * plutofilter_channel_t, as in the table and discrete transfer functions of SVG feComponentTransfer.
+ * The result is premultiplied again. The input and output surfaces may refer to the same buffer.
+ * 
+ * @param in The input surface.
+ * @param out The output surface.
+ * @param tables The red, green, blue and alpha lookup tables.
+ */
+PLUTOFILTER_API void plutofilter_color_transform_table(plutofilter_surface_t in, plutofilter_surface_t out, const uint8_t tables[4][256]);
+
 /**
  * @brief Applies a Gaussian blur to the input surface.
  * 
@@ -268,656 +329,4629 @@ PLUTOFILTER_API void plutofilter_color_transform_linear_rgb_to_srgb(plutofilter_
 PLUTOFILTER_API void plutofilter_gaussian_blur(plutofilter_surface_t in, plutofilter_surface_t out, float std_deviation_x, float std_deviation_y);
 
 /**
- * @brief Blend modes for combining source and backdrop surfaces.
+ * @brief Sharpens the input surface with an unsharp mask.
+ *
+ * Each channel moves away from its Gaussian-blurred value by `amount` times their difference, that is
+ * `in + amount * (in - blur(in))`, on premultiplied channels. Channels within `threshold` of their blurred
+ * value are left unchanged, so flat areas and fine noise are not amplified. The combination happens in the
+ * blur's last vertical pass, without an intermediate surface.
+ *
+ * The input and output surfaces must not overlap.
+ *
+ * @param in The input surface.
+ * @param out The output surface.
+ * @param std_deviation The standard deviation of the blur, which sets the size of the details sharpened.
+ * @param amount The strength of the sharpening; `0` leaves the input unchanged.
+ * @param threshold The smallest difference, from 0 to 1, between a channel and its blurred value that is sharpened.
  */
-typedef enum plutofilter_blend_mode {
-    PLUTOFILTER_BLEND_MODE_NORMAL,     /**< Standard alpha compositing (source over backdrop) */
-    PLUTOFILTER_BLEND_MODE_MULTIPLY,   /**< Multiplies source and backdrop, producing a darker result */
-    PLUTOFILTER_BLEND_MODE_SCREEN,     /**< Inverts, multiplies, then inverts result, producing a lighter result */
-    PLUTOFILTER_BLEND_MODE_OVERLAY,    /**< Multiplies or screens depending on backdrop tone */
-    PLUTOFILTER_BLEND_MODE_DARKEN,     /**< Chooses the darker of source and backdrop */
-    PLUTOFILTER_BLEND_MODE_LIGHTEN,    /**< Chooses the lighter of source and backdrop */
-    PLUTOFILTER_BLEND_MODE_COLOR_DODGE,/**< Brightens backdrop in proportion to source */
-    PLUTOFILTER_BLEND_MODE_COLOR_BURN, /**< Darkens backdrop in proportion to source */
-    PLUTOFILTER_BLEND_MODE_HARD_LIGHT, /**< Multiplies or screens depending on source tone */
-    PLUTOFILTER_BLEND_MODE_SOFT_LIGHT, /**< Darkens or lightens depending on source tone */
-    PLUTOFILTER_BLEND_MODE_DIFFERENCE, /**< Subtracts darker from lighter color */
-    PLUTOFILTER_BLEND_MODE_EXCLUSION   /**< Similar to difference but with lower contrast */
-} plutofilter_blend_mode_t;
+PLUTOFILTER_API void plutofilter_unsharp_mask(plutofilter_surface_t in, plutofilter_surface_t out, float std_deviation, float amount, float threshold);
 
 /**
- * @brief Blends two input surfaces using the specified blend mode.
- * 
- * Applies the selected blend mode to combine `in1` (source) over `in2` (backdrop).
- * The output surface may refer to either input.
- * 
- * @param in1 The source surface.
- * @param in2 The backdrop surface.
+ * @brief Edge modes for filters that sample pixels outside the input surface.
+ */
+typedef enum plutofilter_edge_mode {
+    PLUTOFILTER_EDGE_MODE_NONE,      /**< Pixels outside the surface are transparent black */
+    PLUTOFILTER_EDGE_MODE_DUPLICATE, /**< Pixels outside the surface repeat the nearest edge pixel */
+    PLUTOFILTER_EDGE_MODE_WRAP       /**< Pixels outside the surface wrap around to the opposite edge */
+} plutofilter_edge_mode_t;
+
+/**
+ * @brief Applies a separable convolution to the input surface.
+ *
+ * Filters each row with `kernel_x`, then each column with `kernel_y`. A kernel of `n` taps is
+ * centered on tap `n / 2`, so it covers the pixels from `-(n / 2)` to `(n - 1) / 2` around each
+ * output pixel. A NULL or empty kernel leaves the corresponding axis unchanged, and only the first
+ * PLUTOFILTER_MAX_KERNEL_SIZE taps of a kernel are used.
+ *
+ * The kernels are applied to premultiplied channels using fixed-point arithmetic. The result is clamped
+ * to the range [0, 255] and the color channels are clamped to the alpha channel.
+ * The input and output surfaces may refer to the same buffer.
+ *
+ * @param in The input surface.
  * @param out The output surface.
- * @param mode The blend mode to apply.
+ * @param kernel_x The horizontal kernel.
+ * @param size_x The number of taps in the horizontal kernel.
+ * @param kernel_y The vertical kernel.
+ * @param size_y The number of taps in the vertical kernel.
+ * @param edge_mode Determines how pixels outside the input surface are sampled.
  */
-PLUTOFILTER_API void plutofilter_blend(plutofilter_surface_t in1, plutofilter_surface_t in2, plutofilter_surface_t out, plutofilter_blend_mode_t mode);
+PLUTOFILTER_API void plutofilter_convolve_separable(plutofilter_surface_t in, plutofilter_surface_t out, const float* kernel_x, int size_x, const float* kernel_y, int size_y, plutofilter_edge_mode_t edge_mode);
 
 /**
- * @brief Compositing operators for combining source and backdrop surfaces.
+ * @brief Applies a convolution matrix to the input surface, as defined by SVG feConvolveMatrix.
+ *
+ * Computes each output pixel as:
+ *
+ *     RESULT(X, Y) = SUM(I, J) SOURCE(X - target_x + J, Y - target_y + I) * kernel[order_x - J - 1, order_y - I - 1] / divisor + bias
+ *
+ * The kernel holds `order_x * order_y` values in row-major order. A `divisor` of 0 uses the sum of the kernel
+ * values, or 1 if that sum is 0. When `preserve_alpha` is non-zero, the color channels are convolved without
+ * premultiplication and the alpha channel is copied from the input. Invalid orders or targets, or orders above
+ * PLUTOFILTER_MAX_CONVOLVE_ORDER, copy the input unchanged.
+ *
+ * Kernels that factor into a row and a column are applied as a separable convolution.
+ * The input and output surfaces must not overlap.
+ *
+ * @param in The input surface.
+ * @param out The output surface.
+ * @param order_x The number of kernel columns.
+ * @param order_y The number of kernel rows.
+ * @param kernel The kernel matrix, `order_x * order_y` values in row-major order.
+ * @param divisor The value each sum is divided by (0 for the sum of the kernel values).
+ * @param bias The offset added to each result, in the range [-1, 1].
+ * @param target_x The kernel column aligned with the output pixel (0 to `order_x - 1`).
+ * @param target_y The kernel row aligned with the output pixel (0 to `order_y - 1`).
+ * @param edge_mode Determines how pixels outside the input surface are sampled.
+ * @param preserve_alpha Non-zero to convolve the color channels only.
  */
-typedef enum plutofilter_composite_operator {
-    PLUTOFILTER_COMPOSITE_OPERATOR_OVER, /**< Display source over backdrop */
-    PLUTOFILTER_COMPOSITE_OPERATOR_IN,   /**< Keep only portions of source within backdrop */
-    PLUTOFILTER_COMPOSITE_OPERATOR_OUT,  /**< Keep only portions of source outside backdrop */
-    PLUTOFILTER_COMPOSITE_OPERATOR_ATOP, /**< Display source over backdrop, preserving backdrop alpha */
-    PLUTOFILTER_COMPOSITE_OPERATOR_XOR   /**< Keep non‑overlapping parts of both source and backdrop */
-} plutofilter_composite_operator_t;
+PLUTOFILTER_API void plutofilter_convolve_matrix(plutofilter_surface_t in, plutofilter_surface_t out, int order_x, int order_y, const float* kernel,
+                                                 float divisor, float bias, int target_x, int target_y, plutofilter_edge_mode_t edge_mode, int preserve_alpha);
 
 /**
- * @brief Composites two input surfaces using the specified operator.
- * 
- * Applies the selected compositing rule to combine `in1` (source) over `in2` (backdrop).
- * The output surface may refer to the same buffer as either input.
- * 
- * @param in1 The source surface.
- * @param in2 The backdrop surface.
+ * @brief Morphology operators for thinning or fattening a surface.
+ */
+typedef enum plutofilter_morphology_operator {
+    PLUTOFILTER_MORPHOLOGY_OPERATOR_ERODE, /**< Takes the minimum of each channel over the window, thinning the image */
+    PLUTOFILTER_MORPHOLOGY_OPERATOR_DILATE /**< Takes the maximum of each channel over the window, fattening the image */
+} plutofilter_morphology_operator_t;
+
+/**
+ * @brief Erodes or dilates the input surface, as defined by SVG feMorphology.
+ *
+ * Each output channel is the minimum (erode) or maximum (dilate) of that channel over a rectangle of
+ * `2 * radius_x + 1` by `2 * radius_y + 1` pixels centered on the output pixel, clipped to the input surface.
+ * The cost per pixel does not depend on the radius. A radius of 0 or less leaves that axis unchanged,
+ * and radii are clamped to PLUTOFILTER_MAX_KERNEL_SIZE / 2.
+ *
+ * The input and output surfaces may refer to the same buffer.
+ *
+ * @param in The input surface.
  * @param out The output surface.
- * @param op The compositing operator to apply.
+ * @param op The morphology operator to apply.
+ * @param radius_x The horizontal radius of the window, in pixels.
+ * @param radius_y The vertical radius of the window, in pixels.
  */
-PLUTOFILTER_API void plutofilter_composite(plutofilter_surface_t in1, plutofilter_surface_t in2, plutofilter_surface_t out, plutofilter_composite_operator_t op);
+PLUTOFILTER_API void plutofilter_morphology(plutofilter_surface_t in, plutofilter_surface_t out, plutofilter_morphology_operator_t op, int radius_x, int radius_y);
 
 /**
- * @brief Composites two input surfaces using an arithmetic combination of their color components.
- * 
- * Computes each output channel as:  
- * result = k1 * in1 * in2 + k2 * in1 + k3 * in2 + k4
- * The result is clamped to the valid range.
+ * @brief Computes a distance field from the alpha channel of the input surface.
  *
- * The output surface may refer to the same buffer as either input.
+ * Pixels with an alpha of at least 128 are treated as inside the shape. Every other pixel receives
+ * an alpha proportional to its exact Euclidean distance from the shape, reaching 255 at `max_distance`
+ * pixels or more. Pixels inside the shape receive an alpha of 0, and the color channels are set to zero.
+ * The cost per pixel does not depend on the distances involved.
  *
- * @param in1 The source surface.
- * @param in2 The backdrop surface.
+ * The input and output surfaces must not overlap.
+ *
+ * @param in The input surface.
  * @param out The output surface.
- * @param k1 The coefficient for in1 * in2.
- * @param k2 The coefficient for in1.
- * @param k3 The coefficient for in2.
- * @param k4 The constant bias term.
+ * @param max_distance The distance, in pixels, mapped to an alpha of 255.
  */
-PLUTOFILTER_API void plutofilter_composite_arithmetic(plutofilter_surface_t in1, plutofilter_surface_t in2, plutofilter_surface_t out, float k1, float k2, float k3, float k4);
+PLUTOFILTER_API void plutofilter_distance_transform(plutofilter_surface_t in, plutofilter_surface_t out, float max_distance);
 
-#ifdef __cplusplus
-}
-#endif
+/**
+ * @brief Grows the shape in the alpha channel of the input surface by a Euclidean distance.
+ *
+ * Produces an anti-aliased mask of every pixel within `width` pixels of the shape, with round corners
+ * regardless of the width. The mask is stored in the alpha channel and the color channels are set to zero,
+ * so it can be colored and placed under the input using plutofilter_composite to draw an outline.
+ *
+ * The input and output surfaces must not overlap.
+ *
+ * @param in The input surface.
+ * @param out The output surface.
+ * @param width The outline width, in pixels.
+ */
+PLUTOFILTER_API void plutofilter_distance_outline(plutofilter_surface_t in, plutofilter_surface_t out, float width);
 
-#endif // PLUTOFILTER_H
+/**
+ * @brief Produces a glow that fades out with the Euclidean distance from the shape in the input surface.
+ *
+ * The glow is opaque inside the shape and falls off smoothly to zero at `radius` pixels from it.
+ * The result is stored in the alpha channel and the color channels are set to zero.
+ *
+ * The input and output surfaces must not overlap.
+ *
+ * @param in The input surface.
+ * @param out The output surface.
+ * @param radius The distance, in pixels, at which the glow vanishes.
+ */
+PLUTOFILTER_API void plutofilter_distance_glow(plutofilter_surface_t in, plutofilter_surface_t out, float radius);
 
-#ifdef PLUTOFILTER_IMPLEMENTATION
+/**
+ * @brief The number of 32-bit entries of a summed-area table for a surface of the given size.
+ */
+#define PLUTOFILTER_SUMMED_AREA_TABLE_SIZE(width, height) (4 * ((size_t)(width) + 1) * ((size_t)(height) + 1))
 
-#include <math.h>
+/**
+ * @brief Builds a summed-area table of the input surface.
+ *
+ * The table holds `(width + 1) * (height + 1)` entries of four channels (red, green, blue, alpha), where the entry
+ * at column `x` and row `y` is the sum of every pixel above and to the left of pixel (`x`, `y`). The first row and
+ * column are zero. Sums wrap around modulo 2^32, so the sum of any rectangle of fewer than 16843009 pixels,
+ * computed from four entries with unsigned arithmetic, is exact.
+ *
+ * @param in The input surface.
+ * @param table The table, at least PLUTOFILTER_SUMMED_AREA_TABLE_SIZE(width, height) entries long.
+ */
+PLUTOFILTER_API void plutofilter_summed_area_table(plutofilter_surface_t in, uint32_t* table);
 
-plutofilter_surface_t plutofilter_surface_make(uint32_t* pixels, uint16_t width, uint16_t height, uint32_t stride)
-{
-    plutofilter_surface_t surface;
+/**
+ * @brief Filters for blurs whose radius varies across the surface.
+ */
+typedef enum plutofilter_variable_blur_filter {
+    PLUTOFILTER_VARIABLE_BLUR_FILTER_BOX, /**< Averages a square window, the cheapest filter */
+    PLUTOFILTER_VARIABLE_BLUR_FILTER_TENT /**< Weights the window toward its center, approximated by nested boxes */
+} plutofilter_variable_blur_filter_t;
 
-    surface.pixels = pixels;
-    surface.width = width;
-    surface.height = height;
-    surface.stride = stride;
+/**
+ * @brief Blurs the input surface with a radius that varies per pixel.
+ *
+ * The blur radius of each pixel is the alpha channel of `radius_map` at the same position, scaled so that 255
+ * maps to `max_radius` pixels. The window is clipped to the surface and fractional radii are interpolated,
+ * so gradients in the radius map produce smooth transitions. The cost per pixel does not depend on the radius.
+ * The radius is clamped to 2047 pixels.
+ *
+ * The table is filled from the input surface, as by plutofilter_summed_area_table, before any pixel is written,
+ * so the input, radius map and output surfaces may refer to the same buffer.
+ *
+ * @param in The input surface.
+ * @param radius_map The surface whose alpha channel holds the blur radius of each pixel.
+ * @param out The output surface.
+ * @param max_radius The radius, in pixels, of a fully opaque radius map pixel.
+ * @param filter The filter to apply.
+ * @param table A scratch table, at least PLUTOFILTER_SUMMED_AREA_TABLE_SIZE(width, height) entries long.
+ */
+PLUTOFILTER_API void plutofilter_variable_blur(plutofilter_surface_t in, plutofilter_surface_t radius_map, plutofilter_surface_t out, float max_radius, plutofilter_variable_blur_filter_t filter, uint32_t* table);
 
-    return surface;
-}
+/**
+ * @brief Blurs the input surface along a direction with a box kernel.
+ *
+ * Each pixel is averaged with its neighbours along a line through it at the given angle, as if the content
+ * moved `distance` pixels during the exposure. The line is walked pixel by pixel with a running sum, so
+ * the cost per pixel does not depend on the distance, and the ends of the window are weighted by their
+ * fractional coverage. Content beyond the edges of the surface is treated as transparent.
+ *
+ * The input and output surfaces may refer to the same buffer.
+ *
+ * @param in The input surface.
+ * @param out The output surface.
+ * @param angle The direction of the blur in degrees, clockwise from the positive X axis.
+ * @param distance The length of the blur in pixels, clamped to 510 steps along the line.
+ */
+PLUTOFILTER_API void plutofilter_motion_blur(plutofilter_surface_t in, plutofilter_surface_t out, float angle, float distance);
 
-plutofilter_surface_t plutofilter_surface_make_sub(plutofilter_surface_t surface, uint16_t x, uint16_t y, uint16_t width, uint16_t height)
-{
-    if(x > surface.width) x = surface.width;
-    if(y > surface.height) y = surface.height;
-    if(x + width > surface.width) width = surface.width - x;
-    if(y + height > surface.height) height = surface.height - y;
+/**
+ * @brief Blurs the input surface along a direction with a Gaussian kernel.
+ *
+ * Approximates a one-dimensional Gaussian along the line at the given angle with three successive
+ * box passes, as plutofilter_gaussian_blur does along each axis.
+ *
+ * The input and output surfaces may refer to the same buffer.
+ *
+ * @param in The input surface.
+ * @param out The output surface.
+ * @param angle The direction of the blur in degrees, clockwise from the positive X axis.
+ * @param std_deviation The standard deviation of the blur in pixels.
+ */
+PLUTOFILTER_API void plutofilter_directional_blur(plutofilter_surface_t in, plutofilter_surface_t out, float angle, float std_deviation);
 
-    return plutofilter_surface_make(surface.pixels + (y * surface.stride + x), width, height, surface.stride);
-}
+/**
+ * @brief Filters for halving the size of a surface.
+ */
+typedef enum plutofilter_downsample_filter {
+    PLUTOFILTER_DOWNSAMPLE_FILTER_BOX, /**< Averages each 2x2 block of input pixels */
+    PLUTOFILTER_DOWNSAMPLE_FILTER_TENT /**< Weights a 4x4 neighbourhood by 1, 3, 3, 1 along each axis, reducing aliasing */
+} plutofilter_downsample_filter_t;
 
-#define PLUTOFILTER_ALPHA(pixel) (((pixel) >> 24) & 0xFF)
-#define PLUTOFILTER_RED(pixel) (((pixel) >> 16) & 0xFF)
-#define PLUTOFILTER_GREEN(pixel) (((pixel) >> 8) & 0xFF)
-#define PLUTOFILTER_BLUE(pixel) (((pixel) >> 0) & 0xFF)
+/**
+ * @brief Color spaces in which pixels are filtered.
+ */
+typedef enum plutofilter_color_space {
+    PLUTOFILTER_COLOR_SPACE_SRGB, /**< Filters the stored sRGB values directly */
+    PLUTOFILTER_COLOR_SPACE_LINEAR_RGB /**< Converts to linear light before filtering and back to sRGB afterwards */
+} plutofilter_color_space_t;
 
-#define PLUTOFILTER_UNPACK_PIXEL(pixel, r, g, b, a) \
-    do { \
-        (r) = PLUTOFILTER_RED(pixel); \
-        (g) = PLUTOFILTER_GREEN(pixel); \
-        (b) = PLUTOFILTER_BLUE(pixel); \
-        (a) = PLUTOFILTER_ALPHA(pixel); \
-    } while(0)
+/**
+ * @brief Halves the size of the input surface.
+ *
+ * Each output pixel at (`x`, `y`) is filtered from the input pixels around (`2x + 0.5`, `2y + 0.5`), clamping
+ * at the edges, so an output surface of `(width + 1) / 2` by `(height + 1) / 2` pixels covers the whole input.
+ * The output is processed in row order and reads only rows at or below the one it writes, so the output may
+ * share the input buffer and stride.
+ *
+ * @param in The input surface.
+ * @param out The output surface.
+ * @param filter The filter to apply.
+ * @param color_space The color space in which pixels are averaged.
+ */
+PLUTOFILTER_API void plutofilter_downsample_2x(plutofilter_surface_t in, plutofilter_surface_t out, plutofilter_downsample_filter_t filter, plutofilter_color_space_t color_space);
 
-#define PLUTOFILTER_GET_PIXEL(surface, x, y) \
-    ((surface).pixels[(y) * (surface).stride + (x)])
+/**
+ * @brief Builds a chain of successively halved surfaces.
+ *
+ * The first level is downsampled from the input surface and every further level from the level before it,
+ * as by plutofilter_downsample_2x. Each level should be `(width + 1) / 2` by `(height + 1) / 2` pixels of the
+ * surface before it.
+ *
+ * @param in The input surface.
+ * @param levels The output surfaces, from the largest to the smallest.
+ * @param count The number of output surfaces.
+ * @param filter The filter to apply.
+ * @param color_space The color space in which pixels are averaged.
+ */
+PLUTOFILTER_API void plutofilter_downsample_chain(plutofilter_surface_t in, plutofilter_surface_t* levels, int count, plutofilter_downsample_filter_t filter, plutofilter_color_space_t color_space);
 
-#define PLUTOFILTER_LOAD_PIXEL(in, x, y, r, g, b, a) \
-    do { \
-        uint32_t pixel = PLUTOFILTER_GET_PIXEL(in, x, y); \
-        PLUTOFILTER_UNPACK_PIXEL(pixel, r, g, b, a); \
-    } while(0)
+/**
+ * @brief Filters for resampling a surface.
+ */
+typedef enum plutofilter_resample_filter {
+    PLUTOFILTER_RESAMPLE_FILTER_BILINEAR, /**< Triangle filter with a radius of one pixel */
+    PLUTOFILTER_RESAMPLE_FILTER_BICUBIC, /**< Catmull-Rom cubic with a radius of two pixels */
+    PLUTOFILTER_RESAMPLE_FILTER_LANCZOS /**< Three-lobed Lanczos windowed sinc, the sharpest filter */
+} plutofilter_resample_filter_t;
 
-#define PLUTOFILTER_INIT_LOAD_PIXEL(in, x, y, r, g, b, a) \
-    uint32_t r, g, b, a; \
-    PLUTOFILTER_LOAD_PIXEL(in, x, y, r, g, b, a)
+/**
+ * @brief Resizes the input surface to the size of the output surface.
+ *
+ * Resampling is separable: each output pixel is filtered vertically and then horizontally with weights
+ * precomputed in 14-bit fixed point. When shrinking, the filter widens with the scale factor so that
+ * every input pixel contributes. The filter spans at most 256 input pixels along each axis, which limits
+ * this to shrinking by 128 with bilinear, 64 with bicubic and 42 with Lanczos; shrink further by halving
+ * the input first, as with plutofilter_downsample_2x. Color channels are clamped to alpha so negative lobes
+ * cannot produce invalid premultiplied pixels.
+ *
+ * The input and output surfaces must not overlap.
+ *
+ * @param in The input surface.
+ * @param out The output surface, whose size is the target size.
+ * @param filter The filter to apply.
+ */
+PLUTOFILTER_API void plutofilter_resize(plutofilter_surface_t in, plutofilter_surface_t out, plutofilter_resample_filter_t filter);
 
-#define PLUTOFILTER_PACK_PIXEL(r, g, b, a) \
-    (((uint32_t)(a) << 24) | ((uint32_t)(r) << 16) | ((uint32_t)(g) << 8) | (uint32_t)(b))
+/**
+ * @brief Applies an affine transformation to the input surface.
+ *
+ * The matrix `{a, b, c, d, e, f}` maps a point (`x`, `y`) of the input surface to the point
+ * (`a * x + c * y + e`, `b * x + d * y + f`) of the output surface, as in SVG and canvas transforms. Each output
+ * pixel is sampled at its inverse-mapped center with the given filter, treating everything outside the input
+ * surface as transparent. The output is traversed in tiles for cache locality, and tiles that map entirely
+ * outside the input are cleared without sampling. No prefiltering is done, so shrinking by more than half
+ * aliases; resize with plutofilter_resize first for large reductions. A singular matrix clears the output.
+ *
+ * The input and output surfaces must not overlap.
+ *
+ * @param in The input surface.
+ * @param out The output surface.
+ * @param matrix The 2x3 affine matrix from input to output coordinates.
+ * @param filter The filter to sample with.
+ */
+PLUTOFILTER_API void plutofilter_transform(plutofilter_surface_t in, plutofilter_surface_t out, const float matrix[6], plutofilter_resample_filter_t filter);
 
-#define PLUTOFILTER_STORE_PIXEL(out, x, y, r, g, b, a) \
-    (PLUTOFILTER_GET_PIXEL(out, x, y) = PLUTOFILTER_PACK_PIXEL(r, g, b, a))
+/**
+ * @brief Clockwise rotations by multiples of 90 degrees.
+ */
+typedef enum plutofilter_rotation {
+    PLUTOFILTER_ROTATION_90, /**< Rotates a quarter turn clockwise */
+    PLUTOFILTER_ROTATION_180, /**< Rotates a half turn */
+    PLUTOFILTER_ROTATION_270 /**< Rotates three quarter turns clockwise, or a quarter turn counterclockwise */
+} plutofilter_rotation_t;
 
-#define PLUTOFILTER_PREMULTIPLY_PIXEL(r, g, b, a) \
-    do { \
-        (r) = ((r) * ((a) + 1)) >> 8; \
-        (g) = ((g) * ((a) + 1)) >> 8; \
-        (b) = ((b) * ((a) + 1)) >> 8; \
+/**
+ * @brief Axes to mirror a surface across.
+ */
+typedef enum plutofilter_flip {
+    PLUTOFILTER_FLIP_HORIZONTAL, /**< Mirrors left and right */
+    PLUTOFILTER_FLIP_VERTICAL /**< Mirrors top and bottom */
+} plutofilter_flip_t;
+
+/**
+ * @brief Rotates the input surface by a multiple of 90 degrees.
+ *
+ * Quarter turns swap the width and height, so the output surface should be `height` by `width` pixels of
+ * the input. They are copied in square blocks so both surfaces are accessed cache line by cache line.
+ *
+ * A half turn may be done in place; the input and output surfaces must not overlap otherwise.
+ *
+ * @param in The input surface.
+ * @param out The output surface.
+ * @param rotation The rotation to apply.
+ */
+PLUTOFILTER_API void plutofilter_rotate(plutofilter_surface_t in, plutofilter_surface_t out, plutofilter_rotation_t rotation);
+
+/**
+ * @brief Mirrors the input surface across an axis.
+ *
+ * The input and output surfaces may refer to the same buffer.
+ *
+ * @param in The input surface.
+ * @param out The output surface.
+ * @param flip The axis to mirror across.
+ */
+PLUTOFILTER_API void plutofilter_flip(plutofilter_surface_t in, plutofilter_surface_t out, plutofilter_flip_t flip);
+
+/**
+ * @brief Transposes the input surface, swapping rows and columns.
+ *
+ * The output surface should be `height` by `width` pixels of the input.
+ * The input and output surfaces must not overlap.
+ *
+ * @param in The input surface.
+ * @param out The output surface.
+ */
+PLUTOFILTER_API void plutofilter_transpose(plutofilter_surface_t in, plutofilter_surface_t out);
+
+/**
+ * @brief Brings the input surface upright according to an EXIF orientation tag.
+ *
+ * Orientations 1 to 4 keep the size and may be done in place. Orientations 5 to 8 swap the width and
+ * height, so the output surface should be `height` by `width` pixels of the input, and the input and output
+ * surfaces must not overlap. Other values copy the input.
+ *
+ * @param in The input surface.
+ * @param out The output surface.
+ * @param orientation The EXIF orientation, from 1 to 8.
+ */
+PLUTOFILTER_API void plutofilter_orient(plutofilter_surface_t in, plutofilter_surface_t out, int orientation);
+
+/**
+ * @brief Noise functions for plutofilter_turbulence.
+ */
+typedef enum plutofilter_turbulence_type {
+    PLUTOFILTER_TURBULENCE_TYPE_FRACTAL_NOISE, /**< Sums signed noise octaves, giving soft clouds */
+    PLUTOFILTER_TURBULENCE_TYPE_TURBULENCE /**< Sums absolute noise octaves, giving sharp creases like fire or marble */
+} plutofilter_turbulence_type_t;
+
+/**
+ * @brief Fills the output surface with Perlin turbulence.
+ *
+ * Implements the reference algorithm of the SVG feTurbulence primitive, evaluated at the integer
+ * coordinates of each pixel. The lattice is shared by the four channels, so it is looked up once per pixel
+ * and octave. The generated channels are unpremultiplied values and are premultiplied when stored.
+ *
+ * When `stitch_tiles` is nonzero the base frequencies are adjusted so that the result tiles seamlessly
+ * at the size of the output surface, which lets a single generated tile be repeated across a larger area
+ * or reused across frames.
+ *
+ * @param out The output surface.
+ * @param base_frequency_x The base frequency of the noise along the X axis.
+ * @param base_frequency_y The base frequency of the noise along the Y axis.
+ * @param num_octaves The number of noise octaves.
+ * @param seed The seed of the pseudo-random lattice.
+ * @param stitch_tiles Whether to make the result tile seamlessly.
+ * @param type The noise function.
+ */
+PLUTOFILTER_API void plutofilter_turbulence(plutofilter_surface_t out, float base_frequency_x, float base_frequency_y, int num_octaves, int seed, int stitch_tiles, plutofilter_turbulence_type_t type);
+
+/**
+ * @brief Color channels of a pixel.
+ */
+typedef enum plutofilter_channel {
+    PLUTOFILTER_CHANNEL_R, /**< The red channel */
+    PLUTOFILTER_CHANNEL_G, /**< The green channel */
+    PLUTOFILTER_CHANNEL_B, /**< The blue channel */
+    PLUTOFILTER_CHANNEL_A /**< The alpha channel */
+} plutofilter_channel_t;
+
+/**
+ * @brief Displaces the pixels of the input surface by the values of a map surface.
+ *
+ * Implements the SVG feDisplacementMap primitive: the output pixel at (`x`, `y`) is sampled from the input at
+ * (`x + scale * (X - 0.5)`, `y + scale * (Y - 0.5)`), where X and Y are the selected channels of the
+ * unpremultiplied map pixel at (`x`, `y`), scaled to [0, 1]. Samples are interpolated bilinearly, and areas
+ * outside the input are transparent.
+ *
+ * The map and output surfaces may refer to the same buffer, but the input and output surfaces must not overlap.
+ *
+ * @param in The input surface.
+ * @param map The displacement map surface.
+ * @param out The output surface.
+ * @param scale The displacement, in pixels, of a channel value of one.
+ * @param x_channel The map channel that displaces along the X axis.
+ * @param y_channel The map channel that displaces along the Y axis.
+ */
+PLUTOFILTER_API void plutofilter_displacement_map(plutofilter_surface_t in, plutofilter_surface_t map, plutofilter_surface_t out, float scale, plutofilter_channel_t x_channel, plutofilter_channel_t y_channel);
+
+/**
+ * @brief Kinds of light sources for the lighting filters.
+ */
+typedef enum plutofilter_light_type {
+    PLUTOFILTER_LIGHT_TYPE_DISTANT, /**< Parallel light from a direction, as from the sun */
+    PLUTOFILTER_LIGHT_TYPE_POINT, /**< Light radiating from a position */
+    PLUTOFILTER_LIGHT_TYPE_SPOT /**< Light radiating from a position toward a target, within a cone */
+} plutofilter_light_type_t;
+
+/**
+ * @brief A light source for the lighting filters, mirroring the SVG light source elements.
+ *
+ * Positions are in pixels, with Z pointing out of the surface toward the viewer.
+ */
+typedef struct plutofilter_light_source {
+    plutofilter_light_type_t type; /**< The kind of light */
+    float azimuth; /**< Direction angle of a distant light in the XY plane, in degrees clockwise from the X axis */
+    float elevation; /**< Direction angle of a distant light above the XY plane, in degrees */
+    float x, y, z; /**< Position of a point or spot light */
+    float points_at_x, points_at_y, points_at_z; /**< Position a spot light points at */
+    float specular_exponent; /**< Exponent controlling how a spot light falls off from its axis */
+    float limiting_cone_angle; /**< Half angle, in degrees, outside which a spot light is dark; 90 or more disables the cone */
+} plutofilter_light_source_t;
+
+/**
+ * @brief Lights the alpha channel of the input surface as a bump map with diffuse reflection.
+ *
+ * Implements the SVG feDiffuseLighting primitive. The surface normal at each pixel is computed from the alpha
+ * channel with the Sobel kernels of the specification, and the output color is `diffuse_constant * N.L`
+ * times the lighting color. The output is opaque.
+ *
+ * The input and output surfaces must not overlap.
+ *
+ * @param in The input surface, whose alpha channel is the height map.
+ * @param out The output surface.
+ * @param surface_scale The height of a fully opaque pixel.
+ * @param diffuse_constant The diffuse reflection constant.
+ * @param lighting_color The unpremultiplied 0xAARRGGBB color of the light; its alpha is ignored.
+ * @param light The light source.
+ */
+PLUTOFILTER_API void plutofilter_diffuse_lighting(plutofilter_surface_t in, plutofilter_surface_t out, float surface_scale, float diffuse_constant,
+                                                  uint32_t lighting_color, const plutofilter_light_source_t* light);
+
+/**
+ * @brief Lights the alpha channel of the input surface as a bump map with specular reflection.
+ *
+ * Implements the SVG feSpecularLighting primitive. The output color is
+ * `specular_constant * pow(N.H, specular_exponent)` times the lighting color, where H is the halfway vector
+ * between the light and the viewer, and the output alpha is the largest color channel, so the result can be
+ * composited over the lit image. Exponents from 1 to 128, here and for spot lights, are evaluated through a
+ * lookup table.
+ *
+ * The input and output surfaces must not overlap.
+ *
+ * @param in The input surface, whose alpha channel is the height map.
+ * @param out The output surface.
+ * @param surface_scale The height of a fully opaque pixel.
+ * @param specular_constant The specular reflection constant.
+ * @param specular_exponent The specular exponent; larger values give smaller, sharper highlights.
+ * @param lighting_color The unpremultiplied 0xAARRGGBB color of the light; its alpha is ignored.
+ * @param light The light source.
+ */
+PLUTOFILTER_API void plutofilter_specular_lighting(plutofilter_surface_t in, plutofilter_surface_t out, float surface_scale, float specular_constant,
+                                                   float specular_exponent, uint32_t lighting_color, const plutofilter_light_source_t* light);
+
+/**
+ * @brief A surface shifted within a larger area whose remaining border is transparent.
+ *
+ * The border widths describe the transparent pixels around `surface`, so the view covers an area of
+ * `left + surface.width + right` by `top + surface.height + bottom` pixels without storing them.
+ */
+typedef struct plutofilter_surface_view {
+    plutofilter_surface_t surface; /**< The visible pixels, referencing the source surface */
+    uint16_t left; /**< Width of the transparent border on the left */
+    uint16_t top; /**< Height of the transparent border on the top */
+    uint16_t right; /**< Width of the transparent border on the right */
+    uint16_t bottom; /**< Height of the transparent border on the bottom */
+} plutofilter_surface_view_t;
+
+/**
+ * @brief Describes the input surface offset by a distance, without copying any pixels.
+ *
+ * This is the SVG feOffset primitive as a view: its surface is the part of the input that stays inside the
+ * input bounds after the offset, and its border is the part uncovered by the offset. Filters that map
+ * transparent pixels to transparent pixels can run on the view's surface directly, writing to the
+ * subregion of the output at (`left`, `top`), leaving only the border to be cleared.
+ *
+ * @param in The input surface.
+ * @param dx The horizontal offset, in pixels.
+ * @param dy The vertical offset, in pixels.
+ * @return The view of the offset surface, the same size as the input.
+ */
+PLUTOFILTER_API plutofilter_surface_view_t plutofilter_offset_view(plutofilter_surface_t in, int dx, int dy);
+
+/**
+ * @brief Offsets the input surface by a distance, filling the uncovered area with transparent pixels.
+ *
+ * Implements the SVG feOffset primitive. The input and output surfaces may be the same for in-place filtering.
+ *
+ * @param in The input surface.
+ * @param out The output surface.
+ * @param dx The horizontal offset, in pixels.
+ * @param dy The vertical offset, in pixels.
+ */
+PLUTOFILTER_API void plutofilter_offset(plutofilter_surface_t in, plutofilter_surface_t out, int dx, int dy);
+
+/**
+ * @brief Fills the output surface with repeated copies of the input surface.
+ *
+ * Implements the SVG feTile primitive, with the input surface as the tile. One copy of the tile is placed with
+ * its top-left corner at (`x`, `y`) in the output, and copies repeat from there in every direction. Rows are
+ * built with block copies of the tile and of rows already written.
+ *
+ * The input and output surfaces must not overlap.
+ *
+ * @param in The tile surface.
+ * @param out The output surface.
+ * @param x The horizontal position of a tile in the output, in pixels.
+ * @param y The vertical position of a tile in the output, in pixels.
+ */
+PLUTOFILTER_API void plutofilter_tile(plutofilter_surface_t in, plutofilter_surface_t out, int x, int y);
+
+/**
+ * @brief Fills the output surface with a single color.
+ *
+ * Implements the SVG feFlood primitive.
+ *
+ * @param out The output surface.
+ * @param color The unpremultiplied 0xAARRGGBB color to fill with.
+ */
+PLUTOFILTER_API void plutofilter_flood(plutofilter_surface_t out, uint32_t color);
+
+/**
+ * @brief The largest number of pyramid levels plutofilter_bloom uses.
+ */
+#define PLUTOFILTER_BLOOM_MAX_LEVELS 16
+
+/**
+ * @brief The number of 32-bit entries of scratch memory plutofilter_bloom needs for a surface of the given size.
+ */
+#define PLUTOFILTER_BLOOM_SCRATCH_SIZE(width, height) \
+    (((size_t)(width) * (size_t)(height) + 2) / 3 + (size_t)(width) + (size_t)(height) + PLUTOFILTER_BLOOM_MAX_LEVELS)
+
+/**
+ * @brief Adds a glow around the bright areas of the input surface.
+ *
+ * Pixels brighter than `threshold` are kept in proportion to how far their luminance exceeds it, while
+ * the input is downsampled to half size. The result is reduced further into a pyramid of up to `levels`
+ * levels, each half the size of the previous one, and the levels are upsampled and averaged back from the
+ * smallest up, so each level blurs a wider area. The glow, scaled by `intensity`, is screened onto the
+ * input in the final full-size pass. Apart from that pass, all work happens at a quarter of the input
+ * area or less.
+ *
+ * The input and output surfaces may refer to the same buffer.
+ *
+ * @param in The input surface.
+ * @param out The output surface.
+ * @param threshold The luminance, from 0 to 1, above which pixels glow.
+ * @param intensity The strength of the glow.
+ * @param levels The number of pyramid levels; more levels give a wider glow.
+ * @param scratch Scratch memory, at least PLUTOFILTER_BLOOM_SCRATCH_SIZE(width, height) entries long.
+ */
+PLUTOFILTER_API void plutofilter_bloom(plutofilter_surface_t in, plutofilter_surface_t out, float threshold, float intensity, int levels, uint32_t* scratch);
+
+/**
+ * @brief The largest radius plutofilter_median supports.
+ */
+#define PLUTOFILTER_MEDIAN_MAX_RADIUS 63
+
+/**
+ * @brief Replaces each channel with its median over a square window, removing speckle noise while keeping edges.
+ *
+ * The window is `2 * radius + 1` pixels wide and tall, centered on the output pixel and clipped to the input
+ * surface. Medians are taken per channel on premultiplied values, and color channels are clamped to alpha.
+ * Uses the constant-time column histogram algorithm of Perreault and Hebert, so the cost per pixel barely depends
+ * on the radius. The radius is clamped to PLUTOFILTER_MEDIAN_MAX_RADIUS.
+ *
+ * The input and output surfaces must not overlap.
+ *
+ * @param in The input surface.
+ * @param out The output surface.
+ * @param radius The radius of the window, in pixels.
+ */
+PLUTOFILTER_API void plutofilter_median(plutofilter_surface_t in, plutofilter_surface_t out, int radius);
+
+/**
+ * @brief Returns the number of 32-bit entries of scratch memory plutofilter_bilateral needs.
+ *
+ * @param width The width of the surface in pixels.
+ * @param height The height of the surface in pixels.
+ * @param spatial_sigma The spatial standard deviation that will be passed to plutofilter_bilateral.
+ * @param range_sigma The range standard deviation that will be passed to plutofilter_bilateral.
+ * @return The scratch size, in 32-bit entries.
+ */
+PLUTOFILTER_API size_t plutofilter_bilateral_scratch_size(int width, int height, float spatial_sigma, float range_sigma);
+
+/**
+ * @brief Blurs the input surface while preserving edges, with a bilateral grid.
+ *
+ * Pixels are averaged with their neighbours that have a similar luminance, so smooth areas are blurred
+ * and strong edges are kept. The pixels are accumulated into a grid that is downsampled by `spatial_sigma`
+ * in X and Y and by `range_sigma` in luminance. The grid is blurred along each of its three axes, and each
+ * output pixel is interpolated trilinearly from the grid at its position and luminance. The cost depends
+ * on the number of pixels and the size of the grid, not on the spatial extent of the blur. The spatial
+ * sigma is clamped to 256 pixels.
+ *
+ * The input and output surfaces may refer to the same buffer.
+ *
+ * @param in The input surface.
+ * @param out The output surface.
+ * @param spatial_sigma The spatial standard deviation, in pixels.
+ * @param range_sigma The range standard deviation, as a fraction of the full luminance range from 0 to 1.
+ * @param scratch Scratch memory, at least plutofilter_bilateral_scratch_size() entries long.
+ */
+PLUTOFILTER_API void plutofilter_bilateral(plutofilter_surface_t in, plutofilter_surface_t out, float spatial_sigma, float range_sigma, uint32_t* scratch);
+
+/**
+ * @brief Gradient operators for edge detection.
+ */
+typedef enum plutofilter_edge_operator {
+    PLUTOFILTER_EDGE_OPERATOR_SOBEL, /**< The 3x3 Sobel kernels, weighting rows and columns by 1, 2, 1 */
+    PLUTOFILTER_EDGE_OPERATOR_SCHARR /**< The 3x3 Scharr kernels, weighting rows and columns by 3, 10, 3 for better rotational symmetry */
+} plutofilter_edge_operator_t;
+
+/**
+ * @brief Computes the gradient magnitude of the luminance of the input surface.
+ *
+ * The luminance of each premultiplied pixel, as if composited over black, is computed as the rows are read,
+ * and the horizontal and vertical gradients are taken with the given operator in 16-bit arithmetic. Edge
+ * pixels are repeated beyond the surface. The output is an opaque gray image whose level is the gradient
+ * magnitude, normalized so that a full step from black to white gives 255.
+ *
+ * The input and output surfaces must not overlap.
+ *
+ * @param in The input surface.
+ * @param out The output surface.
+ * @param op The gradient operator.
+ */
+PLUTOFILTER_API void plutofilter_edge_detect(plutofilter_surface_t in, plutofilter_surface_t out, plutofilter_edge_operator_t op);
+
+/**
+ * @brief Computes the gradient magnitude of the luminance of the input surface into an 8-bit buffer.
+ *
+ * Same as plutofilter_edge_detect, but writes one byte per pixel, for detectors that only need the magnitude.
+ *
+ * @param in The input surface.
+ * @param out The output buffer, at least `stride * height` bytes long.
+ * @param stride The number of bytes per row of the output buffer.
+ * @param op The gradient operator.
+ */
+PLUTOFILTER_API void plutofilter_edge_detect_a8(plutofilter_surface_t in, uint8_t* out, uint32_t stride, plutofilter_edge_operator_t op);
+
+/**
+ * @brief Per-channel histograms of a surface.
+ */
+typedef struct plutofilter_histogram {
+    uint32_t counts[4][256]; /**< The number of pixels with each channel value, indexed by plutofilter_channel_t and value */
+    uint32_t total; /**< The number of pixels counted */
+} plutofilter_histogram_t;
+
+/**
+ * @brief Per-channel statistics of a surface.
+ */
+typedef struct plutofilter_stats {
+    uint8_t min[4]; /**< The smallest value of each channel, indexed by plutofilter_channel_t */
+    uint8_t max[4]; /**< The largest value of each channel */
+    float mean[4]; /**< The average value of each channel */
+    float standard_deviation[4]; /**< The standard deviation of each channel */
+} plutofilter_stats_t;
+
+/**
+ * @brief Counts the values of each channel of the input surface.
+ *
+ * Pixels are counted into several private sub-histograms that are merged at the end, so runs of equal values
+ * do not serialize on a single counter. To restrict the histogram to a rectangle, pass a subregion made with
+ * plutofilter_surface_make_sub.
+ *
+ * @param in The input surface.
+ * @param histogram The histogram to fill.
+ * @param unpremultiply Nonzero to count unpremultiplied color values, zero to count the stored premultiplied values.
+ */
+PLUTOFILTER_API void plutofilter_histogram(plutofilter_surface_t in, plutofilter_histogram_t* histogram, int unpremultiply);
+
+/**
+ * @brief Computes the minimum, maximum, mean and standard deviation of each channel of the input surface.
+ *
+ * The statistics are reduced from a histogram of the surface, built as by plutofilter_histogram. An empty
+ * surface gives all zeros.
+ *
+ * @param in The input surface.
+ * @param stats The statistics to fill.
+ * @param unpremultiply Nonzero to measure unpremultiplied color values, zero to measure the stored premultiplied values.
+ */
+PLUTOFILTER_API void plutofilter_stats(plutofilter_surface_t in, plutofilter_stats_t* stats, int unpremultiply);
+
+/**
+ * @brief Stretches each color channel of the input surface to the full range.
+ *
+ * A histogram of the unpremultiplied colors is reduced to the darkest and brightest value of each color
+ * channel, ignoring the `clip` fraction of pixels at each end. A lookup table that maps that range to 0..255
+ * is then applied with plutofilter_color_transform_table. Alpha is unchanged. Fully transparent pixels are
+ * left out of the histogram, so a transparent background does not count as black.
+ *
+ * The input and output surfaces may refer to the same buffer.
+ *
+ * @param in The input surface.
+ * @param out The output surface.
+ * @param clip The fraction of pixels, from 0 to 0.5, ignored at each end of every channel; e.g. 0.005.
+ */
+PLUTOFILTER_API void plutofilter_auto_levels(plutofilter_surface_t in, plutofilter_surface_t out, float clip);
+
+/**
+ * @brief Equalizes the histogram of each color channel of the input surface.
+ *
+ * Each unpremultiplied color value is mapped through the cumulative histogram of its channel, so the values
+ * spread evenly over the full range. The lookup tables are applied with plutofilter_color_transform_table.
+ * Alpha is unchanged. Fully transparent pixels are left out of the histogram, so a transparent background does
+ * not count as black.
+ *
+ * The input and output surfaces may refer to the same buffer.
+ *
+ * @param in The input surface.
+ * @param out The output surface.
+ */
+PLUTOFILTER_API void plutofilter_equalize(plutofilter_surface_t in, plutofilter_surface_t out);
+
+/**
+ * @brief Dithering methods for quantizing to 8 bits per channel.
+ */
+typedef enum plutofilter_dither {
+    PLUTOFILTER_DITHER_NONE, /**< Rounds each channel to the nearest level */
+    PLUTOFILTER_DITHER_ORDERED, /**< Adds an 8x8 Bayer threshold pattern before truncating; each pixel is independent */
+    PLUTOFILTER_DITHER_FLOYD_STEINBERG /**< Diffuses the rounding error of each pixel to its unvisited neighbours */
+} plutofilter_dither_t;
+
+/**
+ * @brief The number of floats of scratch memory plutofilter_quantize needs for Floyd-Steinberg dithering of a
+ * surface of the given width.
+ */
+#define PLUTOFILTER_QUANTIZE_SCRATCH_SIZE(width) (8 * ((size_t)(width) + 2))
+
+/**
+ * @brief Quantizes a floating-point surface to ARGB32, with optional dithering against banding.
+ *
+ * Channels are clamped to [0, 1] and scaled to [0, 255] without any color space conversion. Ordered dithering
+ * applies the same threshold to all four channels of a pixel, so color channels never exceed alpha. Floyd-Steinberg
+ * dithering visits rows in alternating directions and gives smoother results, but each pixel depends on the
+ * ones before it. Its errors are carried in two rows of caller-provided scratch memory, so the input is never
+ * modified. Only the error within [0, 1] is diffused, so values outside that range clip without spreading into
+ * their neighbours.
+ *
+ * @param in The input floating-point surface.
+ * @param out The output surface.
+ * @param dither The dithering method.
+ * @param scratch Scratch memory, at least PLUTOFILTER_QUANTIZE_SCRATCH_SIZE(width) floats long; may be NULL unless
+ *        `dither` is PLUTOFILTER_DITHER_FLOYD_STEINBERG.
+ */
+PLUTOFILTER_API void plutofilter_quantize(plutofilter_float_surface_t in, plutofilter_surface_t out, plutofilter_dither_t dither, float* scratch);
+
+/**
+ * @brief Tone mapping operators for compressing high dynamic range colors into [0, 1].
+ */
+typedef enum plutofilter_tone_map {
+    PLUTOFILTER_TONE_MAP_NONE, /**< Clamps values above 1 */
+    PLUTOFILTER_TONE_MAP_REINHARD, /**< Reinhard: x / (1 + x) */
+    PLUTOFILTER_TONE_MAP_ACES, /**< Narkowicz's fit of the ACES filmic curve */
+    PLUTOFILTER_TONE_MAP_HABLE /**< Hable's filmic curve from Uncharted 2, with a white point of 11.2 */
+} plutofilter_tone_map_t;
+
+/**
+ * @brief Tone maps a linear high dynamic range surface into an sRGB ARGB32 surface.
+ *
+ * Each pixel is unpremultiplied, scaled by `exposure`, mapped through the tone curve per channel,
+ * encoded to sRGB and premultiplied again, all in a single pass. The input colors are expected in
+ * linear RGB, and the input surface is not modified.
+ *
+ * @param in The input floating-point surface, in linear RGB.
+ * @param out The output surface.
+ * @param tone_map The tone mapping operator.
+ * @param exposure The linear scale applied to colors before tone mapping.
+ */
+PLUTOFILTER_API void plutofilter_tone_map(plutofilter_float_surface_t in, plutofilter_surface_t out, plutofilter_tone_map_t tone_map, float exposure);
+
+/**
+ * @brief Fills the output surface with opaque white noise.
+ *
+ * Each pixel is a hash of `seed`, `frame` and its position in the surface, so the noise is the same
+ * whatever order or grouping the pixels are generated in, and changing `frame` gives an independent pattern.
+ *
+ * @param out The output surface.
+ * @param seed The seed of the noise.
+ * @param frame The frame number, for animated noise.
+ * @param monochrome If nonzero, the three color channels share one value.
+ */
+PLUTOFILTER_API void plutofilter_noise(plutofilter_surface_t out, uint32_t seed, uint32_t frame, int monochrome);
+
+/**
+ * @brief Adds film grain to the input surface.
+ *
+ * Adds zero-mean noise with a triangular distribution to each color channel, scaled by `amount` and by the
+ * alpha of the pixel, and clamped to the valid premultiplied range. Alpha is unchanged. The noise is hashed
+ * from `seed`, `frame` and the position of each pixel, as in plutofilter_noise.
+ *
+ * @param in The input surface.
+ * @param out The output surface.
+ * @param amount The largest change of a channel, as a fraction of full intensity, in the range [0, 1].
+ * @param seed The seed of the grain.
+ * @param frame The frame number, for animated grain.
+ * @param monochrome If nonzero, the three color channels receive the same grain.
+ */
+PLUTOFILTER_API void plutofilter_film_grain(plutofilter_surface_t in, plutofilter_surface_t out, float amount, uint32_t seed, uint32_t frame, int monochrome);
+
+/**
+ * @brief Fills a 256-entry color ramp for plutofilter_gradient_map with evenly spaced color stops.
+ *
+ * The stops are premultiplied and interpolated linearly, so two stops give a duotone ramp from shadows
+ * to highlights.
+ *
+ * @param ramp The ramp to fill with premultiplied 0xAARRGGBB colors.
+ * @param colors The unpremultiplied 0xAARRGGBB color stops, from shadows to highlights.
+ * @param count The number of color stops.
+ */
+PLUTOFILTER_API void plutofilter_gradient_ramp(uint32_t ramp[256], const uint32_t* colors, int count);
+
+/**
+ * @brief Recolors the input surface by looking up its luminance in a color ramp.
+ *
+ * The luminance of each unpremultiplied pixel indexes `ramp`, and the ramp color is scaled by the alpha
+ * of the pixel, so opaque ramp colors preserve the input alpha. This replaces a luminance-to-alpha pass,
+ * a lookup pass and a composite pass with a single pass.
+ *
+ * @param in The input surface.
+ * @param out The output surface.
+ * @param ramp 256 premultiplied 0xAARRGGBB colors, from shadows to highlights.
+ */
+PLUTOFILTER_API void plutofilter_gradient_map(plutofilter_surface_t in, plutofilter_surface_t out, const uint32_t ramp[256]);
+
+/**
+ * @brief Blend modes for combining source and backdrop surfaces.
+ */
+typedef enum plutofilter_blend_mode {
+    PLUTOFILTER_BLEND_MODE_NORMAL,     /**< Standard alpha compositing (source over backdrop) */
+    PLUTOFILTER_BLEND_MODE_MULTIPLY,   /**< Multiplies source and backdrop, producing a darker result */
+    PLUTOFILTER_BLEND_MODE_SCREEN,     /**< Inverts, multiplies, then inverts result, producing a lighter result */
+    PLUTOFILTER_BLEND_MODE_OVERLAY,    /**< Multiplies or screens depending on backdrop tone */
+    PLUTOFILTER_BLEND_MODE_DARKEN,     /**< Chooses the darker of source and backdrop */
+    PLUTOFILTER_BLEND_MODE_LIGHTEN,    /**< Chooses the lighter of source and backdrop */
+    PLUTOFILTER_BLEND_MODE_COLOR_DODGE,/**< Brightens backdrop in proportion to source */
+    PLUTOFILTER_BLEND_MODE_COLOR_BURN, /**< Darkens backdrop in proportion to source */
+    PLUTOFILTER_BLEND_MODE_HARD_LIGHT, /**< Multiplies or screens depending on source tone */
+    PLUTOFILTER_BLEND_MODE_SOFT_LIGHT, /**< Darkens or lightens depending on source tone */
+    PLUTOFILTER_BLEND_MODE_DIFFERENCE, /**< Subtracts darker from lighter color */
+    PLUTOFILTER_BLEND_MODE_EXCLUSION   /**< Similar to difference but with lower contrast */
+} plutofilter_blend_mode_t;
+
+/**
+ * @brief Blends two input surfaces using the specified blend mode.
+ * 
+ * Applies the selected blend mode to combine `in1` (source) over `in2` (backdrop).
+ * The output surface may refer to either input.
+ * 
+ * @param in1 The source surface.
+ * @param in2 The backdrop surface.
+ * @param out The output surface.
+ * @param mode The blend mode to apply.
+ */
+PLUTOFILTER_API void plutofilter_blend(plutofilter_surface_t in1, plutofilter_surface_t in2, plutofilter_surface_t out, plutofilter_blend_mode_t mode);
+
+/**
+ * @brief Compositing operators for combining source and backdrop surfaces.
+ */
+typedef enum plutofilter_composite_operator {
+    PLUTOFILTER_COMPOSITE_OPERATOR_OVER, /**< Display source over backdrop */
+    PLUTOFILTER_COMPOSITE_OPERATOR_IN,   /**< Keep only portions of source within backdrop */
+    PLUTOFILTER_COMPOSITE_OPERATOR_OUT,  /**< Keep only portions of source outside backdrop */
+    PLUTOFILTER_COMPOSITE_OPERATOR_ATOP, /**< Display source over backdrop, preserving backdrop alpha */
+    PLUTOFILTER_COMPOSITE_OPERATOR_XOR   /**< Keep non‑overlapping parts of both source and backdrop */
+} plutofilter_composite_operator_t;
+
+/**
+ * @brief Composites two input surfaces using the specified operator.
+ * 
+ * Applies the selected compositing rule to combine `in1` (source) over `in2` (backdrop).
+ * The output surface may refer to the same buffer as either input.
+ * 
+ * @param in1 The source surface.
+ * @param in2 The backdrop surface.
+ * @param out The output surface.
+ * @param op The compositing operator to apply.
+ */
+PLUTOFILTER_API void plutofilter_composite(plutofilter_surface_t in1, plutofilter_surface_t in2, plutofilter_surface_t out, plutofilter_composite_operator_t op);
+
+/**
+ * @brief Composites two input surfaces using an arithmetic combination of their color components.
+ * 
+ * Computes each output channel as:  
+ * result = k1 * in1 * in2 + k2 * in1 + k3 * in2 + k4
+ * The result is clamped to the valid range.
+ *
+ * The output surface may refer to the same buffer as either input.
+ *
+ * @param in1 The source surface.
+ * @param in2 The backdrop surface.
+ * @param out The output surface.
+ * @param k1 The coefficient for in1 * in2.
+ * @param k2 The coefficient for in1.
+ * @param k3 The coefficient for in2.
+ * @param k4 The constant bias term.
+ */
+PLUTOFILTER_API void plutofilter_composite_arithmetic(plutofilter_surface_t in1, plutofilter_surface_t in2, plutofilter_surface_t out, float k1, float k2, float k3, float k4);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // PLUTOFILTER_H
+
+#ifdef PLUTOFILTER_IMPLEMENTATION
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+plutofilter_surface_t plutofilter_surface_make(uint32_t* pixels, uint16_t width, uint16_t height, uint32_t stride)
+{
+    plutofilter_surface_t surface;
+
+    surface.pixels = pixels;
+    surface.width = width;
+    surface.height = height;
+    surface.stride = stride;
+
+    return surface;
+}
+
+plutofilter_surface_t plutofilter_surface_make_sub(plutofilter_surface_t surface, uint16_t x, uint16_t y, uint16_t width, uint16_t height)
+{
+    if(x > surface.width) x = surface.width;
+    if(y > surface.height) y = surface.height;
+    if(x + width > surface.width) width = surface.width - x;
+    if(y + height > surface.height) height = surface.height - y;
+
+    return plutofilter_surface_make(surface.pixels + (y * surface.stride + x), width, height, surface.stride);
+}
+
+plutofilter_float_surface_t plutofilter_float_surface_make(float* pixels, uint16_t width, uint16_t height, uint32_t stride)
+{
+    plutofilter_float_surface_t surface;
+
+    surface.pixels = pixels;
+    surface.width = width;
+    surface.height = height;
+    surface.stride = stride;
+
+    return surface;
+}
+
+#define PLUTOFILTER_ALPHA(pixel) (((pixel) >> 24) & 0xFF)
+#define PLUTOFILTER_RED(pixel) (((pixel) >> 16) & 0xFF)
+#define PLUTOFILTER_GREEN(pixel) (((pixel) >> 8) & 0xFF)
+#define PLUTOFILTER_BLUE(pixel) (((pixel) >> 0) & 0xFF)
+
+#define PLUTOFILTER_UNPACK_PIXEL(pixel, r, g, b, a) \
+    do { \
+        (r) = PLUTOFILTER_RED(pixel); \
+        (g) = PLUTOFILTER_GREEN(pixel); \
+        (b) = PLUTOFILTER_BLUE(pixel); \
+        (a) = PLUTOFILTER_ALPHA(pixel); \
+    } while(0)
+
+#define PLUTOFILTER_GET_PIXEL(surface, x, y) \
+    ((surface).pixels[(y) * (surface).stride + (x)])
+
+#define PLUTOFILTER_LOAD_PIXEL(in, x, y, r, g, b, a) \
+    do { \
+        uint32_t pixel = PLUTOFILTER_GET_PIXEL(in, x, y); \
+        PLUTOFILTER_UNPACK_PIXEL(pixel, r, g, b, a); \
+    } while(0)
+
+#define PLUTOFILTER_INIT_LOAD_PIXEL(in, x, y, r, g, b, a) \
+    uint32_t r, g, b, a; \
+    PLUTOFILTER_LOAD_PIXEL(in, x, y, r, g, b, a)
+
+#define PLUTOFILTER_PACK_PIXEL(r, g, b, a) \
+    (((uint32_t)(a) << 24) | ((uint32_t)(r) << 16) | ((uint32_t)(g) << 8) | (uint32_t)(b))
+
+#define PLUTOFILTER_STORE_PIXEL(out, x, y, r, g, b, a) \
+    (PLUTOFILTER_GET_PIXEL(out, x, y) = PLUTOFILTER_PACK_PIXEL(r, g, b, a))
+
+#define PLUTOFILTER_PREMULTIPLY_PIXEL(r, g, b, a) \
+    do { \
+        (r) = ((r) * ((a) + 1)) >> 8; \
+        (g) = ((g) * ((a) + 1)) >> 8; \
+        (b) = ((b) * ((a) + 1)) >> 8; \
+    } while(0)
+
+#define PLUTOFILTER_UNPREMULTIPLY_PIXEL(r, g, b, a) \
+    do { \
+        if((a)) { \
+            (r) = (255 * (r)) / (a); \
+            (g) = (255 * (g)) / (a); \
+            (b) = (255 * (b)) / (a); \
+        } else { \
+            (r) = (g) = (b) = 0; \
+        } \
+    } while(0)
+
+#define PLUTOFILTER_CLAMP(v, lo, hi) \
+    ((v) < (lo) ? (lo) : ((v) > (hi) ? (hi) : (v)))
+
+#define PLUTOFILTER_CLAMP_PIXEL(pixel) \
+    ((uint8_t)(PLUTOFILTER_CLAMP(pixel, 0, 255)))
+
+#define PLUTOFILTER_OVERLAP_SURFACE(a, b) \
+    do { \
+        uint16_t __width = (a).width; \
+        uint16_t __height = (a).height; \
+        if((b).width < __width) __width = (b).width; \
+        if((b).height < __height) __height = (b).height; \
+        (a).width = (b).width = __width; \
+        (a).height = (b).height = __height; \
+    } while(0)
+
+#define PLUTOFILTER_OVERLAP_SURFACE3(a, b, c) \
+    do { \
+        uint16_t __width = (a).width; \
+        uint16_t __height = (a).height; \
+        if((b).width < __width) __width = (b).width; \
+        if((c).width < __width) __width = (c).width; \
+        if((b).height < __height) __height = (b).height; \
+        if((c).height < __height) __height = (c).height; \
+        (a).width = (b).width = (c).width = __width; \
+        (a).height = (b).height = (c).height = __height; \
+    } while(0)
+
+void plutofilter_color_transform(plutofilter_surface_t in, plutofilter_surface_t out, const float matrix[20])
+{
+    PLUTOFILTER_OVERLAP_SURFACE(in, out);
+
+    for(int y = 0; y < out.height; y++) {
+        for(int x = 0; x < out.width; x++) {
+            PLUTOFILTER_INIT_LOAD_PIXEL(in, x, y, r, g, b, a);
+            PLUTOFILTER_UNPREMULTIPLY_PIXEL(r, g, b, a);
+
+            float rr = r * matrix[ 0] + g * matrix[ 1] + b * matrix[ 2] + a * matrix[ 3] + matrix[ 4] * 255;
+            float gg = r * matrix[ 5] + g * matrix[ 6] + b * matrix[ 7] + a * matrix[ 8] + matrix[ 9] * 255;
+            float bb = r * matrix[10] + g * matrix[11] + b * matrix[12] + a * matrix[13] + matrix[14] * 255;
+            float aa = r * matrix[15] + g * matrix[16] + b * matrix[17] + a * matrix[18] + matrix[19] * 255;
+
+            r = PLUTOFILTER_CLAMP_PIXEL(rr);
+            g = PLUTOFILTER_CLAMP_PIXEL(gg);
+            b = PLUTOFILTER_CLAMP_PIXEL(bb);
+            a = PLUTOFILTER_CLAMP_PIXEL(aa);
+
+            PLUTOFILTER_PREMULTIPLY_PIXEL(r, g, b, a);
+            PLUTOFILTER_STORE_PIXEL(out, x, y, r, g, b, a);
+        }
+    }
+}
+
+void plutofilter_color_transform_opacity(plutofilter_surface_t in, plutofilter_surface_t out, float amount)
+{
+    const float matrix[] = {
+        1.0f, 0.0f, 0.0f, 0.0f, 0.0f,
+        0.0f, 1.0f, 0.0f, 0.0f, 0.0f,
+        0.0f, 0.0f, 1.0f, 0.0f, 0.0f,
+        0.0f, 0.0f, 0.0f, amount, 0.0f
+    };
+
+    plutofilter_color_transform(in, out, matrix);
+}
+
+void plutofilter_color_transform_brightness(plutofilter_surface_t in, plutofilter_surface_t out, float amount)
+{
+    const float matrix[] = {
+        amount, 0.0f,   0.0f,   0.0f, 0.0f,
+        0.0f,   amount, 0.0f,   0.0f, 0.0f,
+        0.0f,   0.0f,   amount, 0.0f, 0.0f,
+        0.0f,   0.0f,   0.0f,   1.0f, 0.0f
+    };
+
+    plutofilter_color_transform(in, out, matrix);
+}
+
+void plutofilter_color_transform_invert(plutofilter_surface_t in, plutofilter_surface_t out, float amount)
+{
+    const float scale = 1.0f - 2.0f * amount;
+    const float matrix[] = {
+        scale, 0.0f,  0.0f,  0.0f, amount,
+        0.0f,  scale, 0.0f,  0.0f, amount,
+        0.0f,  0.0f,  scale, 0.0f, amount,
+        0.0f,  0.0f,  0.0f,  1.0f, 0.0f
+    };
+
+    plutofilter_color_transform(in, out, matrix);
+}
+
+void plutofilter_color_transform_contrast(plutofilter_surface_t in, plutofilter_surface_t out, float amount)
+{
+    const float offset = (1.0f - amount) * 0.5f;
+    const float matrix[] = {
+        amount, 0.0f,   0.0f,   0.0f, offset,
+        0.0f,   amount, 0.0f,   0.0f, offset,
+        0.0f,   0.0f,   amount, 0.0f, offset,
+        0.0f,   0.0f,   0.0f,   1.0f, 0.0f
+    };
+
+    plutofilter_color_transform(in, out, matrix);
+}
+
+void plutofilter_color_transform_saturate(plutofilter_surface_t in, plutofilter_surface_t out, float amount)
+{
+    const float matrix[] = {
+        0.213f + 0.787f * amount,
+        0.715f - 0.715f * amount,
+        0.072f - 0.072f * amount,
+        0.0f,
+        0.0f,
+
+        0.213f - 0.213f * amount,
+        0.715f + 0.285f * amount,
+        0.072f - 0.072f * amount,
+        0.0f,
+        0.0f,
+
+        0.213f - 0.213f * amount,
+        0.715f - 0.715f * amount,
+        0.072f + 0.928f * amount,
+        0.0f,
+        0.0f,
+
+        0.0f,
+        0.0f,
+        0.0f,
+        1.0f,
+        0.0f
+    };
+
+    plutofilter_color_transform(in, out, matrix);
+}
+
+void plutofilter_color_transform_grayscale(plutofilter_surface_t in, plutofilter_surface_t out, float amount)
+{
+    const float inv_amount = 1.0f - amount;
+    const float matrix[] = {
+        inv_amount + amount * 0.2126f,
+        amount * 0.7152f,
+        amount * 0.0722f,
+        0.0f,
+        0.0f,
+
+        amount * 0.2126f,
+        inv_amount + amount * 0.7152f,
+        amount * 0.0722f,
+        0.0f,
+        0.0f,
+
+        amount * 0.2126f,
+        amount * 0.7152f,
+        inv_amount + amount * 0.0722f,
+        0.0f,
+        0.0f,
+
+        0.0f,
+        0.0f,
+        0.0f,
+        1.0f,
+        0.0f
+    };
+
+    plutofilter_color_transform(in, out, matrix);
+}
+
+void plutofilter_color_transform_sepia(plutofilter_surface_t in, plutofilter_surface_t out, float amount)
+{
+    const float inv_amount = 1.0f - amount;
+    const float matrix[] = {
+        0.393f + 0.607f * inv_amount,
+        0.769f - 0.769f * inv_amount,
+        0.189f - 0.189f * inv_amount,
+        0.0f,
+        0.0f,
+
+        0.349f - 0.349f * inv_amount,
+        0.686f + 0.314f * inv_amount,
+        0.168f - 0.168f * inv_amount,
+        0.0f,
+        0.0f,
+
+        0.272f - 0.272f * inv_amount,
+        0.534f - 0.534f * inv_amount,
+        0.131f + 0.869f * inv_amount,
+        0.0f,
+        0.0f,
+
+        0.0f,
+        0.0f,
+        0.0f,
+        1.0f,
+        0.0f
+    };
+
+    plutofilter_color_transform(in, out, matrix);
+}
+
+static inline float plutofilter__deg2rad(float angle) { return angle * (3.14159265358979323846f / 180.0f); }
+
+void plutofilter_color_transform_hue_rotate(plutofilter_surface_t in, plutofilter_surface_t out, float angle)
+{
+    const float a1 = cos(plutofilter__deg2rad(angle));
+    const float a2 = sin(plutofilter__deg2rad(angle));
+    const float matrix[] = {
+        0.213f + a1 * 0.787f - a2 * 0.213f,
+        0.715f - a1 * 0.715f - a2 * 0.715f,
+        0.072f - a1 * 0.072f + a2 * 0.928f,
+        0.0f,
+        0.0f,
+
+        0.213f - a1 * 0.213f + a2 * 0.143f,
+        0.715f + a1 * 0.285f + a2 * 0.140f,
+        0.072f - a1 * 0.072f - a2 * 0.283f,
+        0.0f,
+        0.0f,
+
+        0.213f - a1 * 0.213f - a2 * 0.787f,
+        0.715f - a1 * 0.715f + a2 * 0.715f,
+        0.072f + a1 * 0.928f + a2 * 0.072f,
+        0.0f,
+        0.0f,
+
+        0.0f,
+        0.0f,
+        0.0f,
+        1.0f,
+        0.0f
+    };
+
+    plutofilter_color_transform(in, out, matrix);
+}
+
+void plutofilter_color_transform_luminance_to_alpha(plutofilter_surface_t in, plutofilter_surface_t out)
+{
+    PLUTOFILTER_OVERLAP_SURFACE(in, out);
+
+    for(int y = 0; y < out.height; y++) {
+        for(int x = 0; x < out.width; x++) {
+            PLUTOFILTER_INIT_LOAD_PIXEL(in, x, y, r, g, b, a);
+            PLUTOFILTER_UNPREMULTIPLY_PIXEL(r, g, b, a);
+
+            float l = r * 0.2125f + g * 0.7154f + b * 0.0721f;
+
+            PLUTOFILTER_STORE_PIXEL(out, x, y, 0, 0, 0, PLUTOFILTER_CLAMP_PIXEL(l));
+        }
+    }
+}
+
+static const uint8_t PLUTOFILTER_SRGB_TO_LINEAR_RGB_TABLE[256] = {
+    0,   0,   0,   0,   0,   0,  0,    1,   1,   1,   1,   1,   1,   1,   1,   1,
+    1,   1,   2,   2,   2,   2,  2,    2,   2,   2,   3,   3,   3,   3,   3,   3,
+    4,   4,   4,   4,   4,   5,  5,    5,   5,   6,   6,   6,   6,   7,   7,   7,
+    8,   8,   8,   8,   9,   9,  9,   10,  10,  10,  11,  11,  12,  12,  12,  13,
+    13,  13,  14,  14,  15,  15,  16,  16,  17,  17,  17,  18,  18,  19,  19,  20,
+    20,  21,  22,  22,  23,  23,  24,  24,  25,  25,  26,  27,  27,  28,  29,  29,
+    30,  30,  31,  32,  32,  33,  34,  35,  35,  36,  37,  37,  38,  39,  40,  41,
+    41,  42,  43,  44,  45,  45,  46,  47,  48,  49,  50,  51,  51,  52,  53,  54,
+    55,  56,  57,  58,  59,  60,  61,  62,  63,  64,  65,  66,  67,  68,  69,  70,
+    71,  72,  73,  74,  76,  77,  78,  79,  80,  81,  82,  84,  85,  86,  87,  88,
+    90,  91,  92,  93,  95,  96,  97,  99, 100, 101, 103, 104, 105, 107, 108, 109,
+    111, 112, 114, 115, 116, 118, 119, 121, 122, 124, 125, 127, 128, 130, 131, 133,
+    134, 136, 138, 139, 141, 142, 144, 146, 147, 149, 151, 152, 154, 156, 157, 159,
+    161, 163, 164, 166, 168, 170, 171, 173, 175, 177, 179, 181, 183, 184, 186, 188,
+    190, 192, 194, 196, 198, 200, 202, 204, 206, 208, 210, 212, 214, 216, 218, 220,
+    222, 224, 226, 229, 231, 233, 235, 237, 239, 242, 244, 246, 248, 250, 253, 255,
+};
+
+#define PLUTOFILTER_SRGB_TO_LINEAR_RGB(r, g, b) \
+    do { \
+        (r) = PLUTOFILTER_SRGB_TO_LINEAR_RGB_TABLE[r]; \
+        (g) = PLUTOFILTER_SRGB_TO_LINEAR_RGB_TABLE[g]; \
+        (b) = PLUTOFILTER_SRGB_TO_LINEAR_RGB_TABLE[b]; \
+    } while(0)
+
+void plutofilter_color_transform_srgb_to_linear_rgb(plutofilter_surface_t in, plutofilter_surface_t out)
+{
+    PLUTOFILTER_OVERLAP_SURFACE(in, out);
+
+    for(int y = 0; y < out.height; y++) {
+        for(int x = 0; x < out.width; x++) {
+            PLUTOFILTER_INIT_LOAD_PIXEL(in, x, y, r, g, b, a);
+            PLUTOFILTER_UNPREMULTIPLY_PIXEL(r, g, b, a);
+
+            PLUTOFILTER_SRGB_TO_LINEAR_RGB(r, g, b);
+
+            PLUTOFILTER_PREMULTIPLY_PIXEL(r, g, b, a);
+            PLUTOFILTER_STORE_PIXEL(out, x, y, r, g, b, a);
+        }
+    }
+}
+
+static const uint8_t PLUTOFILTER_LINEAR_RGB_TO_SRGB_TABLE[256] = {
+    0,  13,  22,  28,  34,  38,  42,  46,  50,  53,  56,  59,  61,  64,  66,  69,
+    71,  73,  75,  77,  79,  81,  83,  85,  86,  88,  90,  92,  93,  95,  96,  98,
+    99, 101, 102, 104, 105, 106, 108, 109, 110, 112, 113, 114, 115, 117, 118, 119,
+    120, 121, 122, 124, 125, 126, 127, 128, 129, 130, 131, 132, 133, 134, 135, 136,
+    137, 138, 139, 140, 141, 142, 143, 144, 145, 146, 147, 148, 148, 149, 150, 151,
+    152, 153, 154, 155, 155, 156, 157, 158, 159, 159, 160, 161, 162, 163, 163, 164,
+    165, 166, 167, 167, 168, 169, 170, 170, 171, 172, 173, 173, 174, 175, 175, 176,
+    177, 178, 178, 179, 180, 180, 181, 182, 182, 183, 184, 185, 185, 186, 187, 187,
+    188, 189, 189, 190, 190, 191, 192, 192, 193, 194, 194, 195, 196, 196, 197, 197,
+    198, 199, 199, 200, 200, 201, 202, 202, 203, 203, 204, 205, 205, 206, 206, 207,
+    208, 208, 209, 209, 210, 210, 211, 212, 212, 213, 213, 214, 214, 215, 215, 216,
+    216, 217, 218, 218, 219, 219, 220, 220, 221, 221, 222, 222, 223, 223, 224, 224,
+    225, 226, 226, 227, 227, 228, 228, 229, 229, 230, 230, 231, 231, 232, 232, 233,
+    233, 234, 234, 235, 235, 236, 236, 237, 237, 238, 238, 238, 239, 239, 240, 240,
+    241, 241, 242, 242, 243, 243, 244, 244, 245, 245, 246, 246, 246, 247, 247, 248,
+    248, 249, 249, 250, 250, 251, 251, 251, 252, 252, 253, 253, 254, 254, 255, 255,
+};
+
+#define PLUTOFILTER_LINEAR_RGB_TO_SRGB(r, g, b) \
+    do { \
+        (r) = PLUTOFILTER_LINEAR_RGB_TO_SRGB_TABLE[r]; \
+        (g) = PLUTOFILTER_LINEAR_RGB_TO_SRGB_TABLE[g]; \
+        (b) = PLUTOFILTER_LINEAR_RGB_TO_SRGB_TABLE[b]; \
+    } while(0)
+
+void plutofilter_color_transform_linear_rgb_to_srgb(plutofilter_surface_t in, plutofilter_surface_t out)
+{
+    PLUTOFILTER_OVERLAP_SURFACE(in, out);
+
+    for(int y = 0; y < out.height; y++) {
+        for(int x = 0; x < out.width; x++) {
+            PLUTOFILTER_INIT_LOAD_PIXEL(in, x, y, r, g, b, a);
+            PLUTOFILTER_UNPREMULTIPLY_PIXEL(r, g, b, a);
+
+            PLUTOFILTER_LINEAR_RGB_TO_SRGB(r, g, b);
+
+            PLUTOFILTER_PREMULTIPLY_PIXEL(r, g, b, a);
+            PLUTOFILTER_STORE_PIXEL(out, x, y, r, g, b, a);
+        }
+    }
+}
+
+void plutofilter_color_transform_table(plutofilter_surface_t in, plutofilter_surface_t out, const uint8_t tables[4][256])
+{
+    PLUTOFILTER_OVERLAP_SURFACE(in, out);
+
+    const uint8_t* table_r = tables[PLUTOFILTER_CHANNEL_R];
+    const uint8_t* table_g = tables[PLUTOFILTER_CHANNEL_G];
+    const uint8_t* table_b = tables[PLUTOFILTER_CHANNEL_B];
+    const uint8_t* table_a = tables[PLUTOFILTER_CHANNEL_A];
+    for(int y = 0; y < out.height; y++) {
+        for(int x = 0; x < out.width; x++) {
+            PLUTOFILTER_INIT_LOAD_PIXEL(in, x, y, r, g, b, a);
+            if(a != 255) {
+                PLUTOFILTER_UNPREMULTIPLY_PIXEL(r, g, b, a);
+            }
+
+            r = table_r[r];
+            g = table_g[g];
+            b = table_b[b];
+            a = table_a[a];
+            if(a != 255) {
+                PLUTOFILTER_PREMULTIPLY_PIXEL(r, g, b, a);
+            }
+
+            PLUTOFILTER_STORE_PIXEL(out, x, y, r, g, b, a);
+        }
+    }
+}
+
+#define PLUTOFILTER_BLUR_STORE_PIXEL(out, x, y, r, g, b, a, k) \
+    PLUTOFILTER_STORE_PIXEL(out, x, y, (r) / (k), (g) / (k), (b) / (k), (a) / (k))
+
+#define PLUTOFILTER_MIN(a, b) ((a) < (b) ? (a) : (b))
+#define PLUTOFILTER_MAX(a, b) ((a) > (b) ? (a) : (b))
+
+static void plutofilter__box_blur(plutofilter_surface_t in, plutofilter_surface_t out, uint32_t* intermediate, int kernel_width, int kernel_height)
+{
+    int x, y, offset;
+    uint32_t pixel, r, g, b, a;
+    uint32_t sum_r, sum_g, sum_b, sum_a;
+
+    if(kernel_width > 0) {
+        kernel_width = PLUTOFILTER_MIN(kernel_width, out.width);
+        for(y = 0; y < out.height; y++) {
+            sum_r = sum_g = sum_b = sum_a = 0;
+            for(x = 0; x < kernel_width; x++) {
+                pixel = (intermediate[x % kernel_width] = PLUTOFILTER_GET_PIXEL(in, x, y));
+                PLUTOFILTER_UNPACK_PIXEL(pixel, r, g, b, a);
+
+                sum_r += r;
+                sum_g += g;
+                sum_b += b;
+                sum_a += a;
+
+                offset = x - kernel_width / 2;
+                if(offset >= 0 && offset < out.width) {
+                    PLUTOFILTER_BLUR_STORE_PIXEL(out, offset, y, sum_r, sum_g, sum_b, sum_a, kernel_width);
+                }
+            }
+
+            for(x = kernel_width; x < out.width; x++) {
+                pixel = intermediate[x % kernel_width];
+                PLUTOFILTER_UNPACK_PIXEL(pixel, r, g, b, a);
+
+                sum_r -= r;
+                sum_g -= g;
+                sum_b -= b;
+                sum_a -= a;
+
+                pixel = (intermediate[x % kernel_width] = PLUTOFILTER_GET_PIXEL(in, x, y));
+                PLUTOFILTER_UNPACK_PIXEL(pixel, r, g, b, a);
+
+                sum_r += r;
+                sum_g += g;
+                sum_b += b;
+                sum_a += a;
+
+                offset = x - kernel_width / 2;
+                PLUTOFILTER_BLUR_STORE_PIXEL(out, offset, y, sum_r, sum_g, sum_b, sum_a, kernel_width);
+            }
+
+            for(x = out.width; x < out.width + kernel_width; x++) {
+                pixel = intermediate[x % kernel_width];
+                PLUTOFILTER_UNPACK_PIXEL(pixel, r, g, b, a);
+
+                sum_r -= r;
+                sum_g -= g;
+                sum_b -= b;
+                sum_a -= a;
+
+                offset = x - kernel_width / 2;
+                if(offset >= 0 && offset < out.width) {
+                    PLUTOFILTER_BLUR_STORE_PIXEL(out, offset, y, sum_r, sum_g, sum_b, sum_a, kernel_width);
+                }
+            }
+        }
+    }
+
+    if(kernel_height > 0) {
+        kernel_height = PLUTOFILTER_MIN(kernel_height, out.height);
+        for(x = 0; x < out.width; x++) {
+            sum_r = sum_g = sum_b = sum_a = 0;
+            for(y = 0; y < kernel_height; y++) {
+                pixel = (intermediate[y % kernel_height] = PLUTOFILTER_GET_PIXEL(in, x, y));
+                PLUTOFILTER_UNPACK_PIXEL(pixel, r, g, b, a);
+
+                sum_r += r;
+                sum_g += g;
+                sum_b += b;
+                sum_a += a;
+
+                offset = y - kernel_height / 2;
+                if(offset >= 0 && offset < out.height) {
+                    PLUTOFILTER_BLUR_STORE_PIXEL(out, x, offset, sum_r, sum_g, sum_b, sum_a, kernel_height);
+                }
+            }
+
+            for(y = kernel_height; y < out.height; y++) {
+                pixel = intermediate[y % kernel_height];
+                PLUTOFILTER_UNPACK_PIXEL(pixel, r, g, b, a);
+
+                sum_r -= r;
+                sum_g -= g;
+                sum_b -= b;
+                sum_a -= a;
+
+                pixel = (intermediate[y % kernel_height] = PLUTOFILTER_GET_PIXEL(in, x, y));
+                PLUTOFILTER_UNPACK_PIXEL(pixel, r, g, b, a);
+
+                sum_r += r;
+                sum_g += g;
+                sum_b += b;
+                sum_a += a;
+
+                offset = y - kernel_height / 2;
+                PLUTOFILTER_BLUR_STORE_PIXEL(out, x, offset, sum_r, sum_g, sum_b, sum_a, kernel_height);
+            }
+
+            for(y = out.height; y < out.height + kernel_height; y++) {
+                pixel = intermediate[y % kernel_height];
+                PLUTOFILTER_UNPACK_PIXEL(pixel, r, g, b, a);
+
+                sum_r -= r;
+                sum_g -= g;
+                sum_b -= b;
+                sum_a -= a;
+
+                offset = y - kernel_height / 2;
+                if(offset >= 0 && offset < out.height) {
+                    PLUTOFILTER_BLUR_STORE_PIXEL(out, x, offset, sum_r, sum_g, sum_b, sum_a, kernel_height);
+                }
+            }
+        }
+    }
+}
+
+#define PLUTOFILTER_KERNEL_FACTOR 1.8799712059732503f
+
+static inline int plutofilter__calc_kernel_size(float std_deviation)
+{
+    return (int)(floorf(std_deviation * PLUTOFILTER_KERNEL_FACTOR + 0.5f));
+}
+
+#define PLUTOFILTER_MAX_KERNEL_SIZE 512
+
+void plutofilter_gaussian_blur(plutofilter_surface_t in, plutofilter_surface_t out, float std_deviation_x, float std_deviation_y)
+{
+    PLUTOFILTER_OVERLAP_SURFACE(in, out);
+
+    int kernel_width = plutofilter__calc_kernel_size(std_deviation_x);
+    int kernel_height = plutofilter__calc_kernel_size(std_deviation_y);
+    if(kernel_width <= 0 && kernel_height <= 0) {
+        int size = out.width * out.height;
+        for(int i = 0; i < size; i++)
+            out.pixels[i] = in.pixels[i];
+        return;
+    }
+
+    if(kernel_width > PLUTOFILTER_MAX_KERNEL_SIZE)
+        kernel_width = PLUTOFILTER_MAX_KERNEL_SIZE;
+    if(kernel_height > PLUTOFILTER_MAX_KERNEL_SIZE) {
+        kernel_height = PLUTOFILTER_MAX_KERNEL_SIZE;
+    }
+
+    uint32_t intermediate[PLUTOFILTER_MAX_KERNEL_SIZE];
+
+    plutofilter__box_blur(in, out, intermediate, kernel_width, kernel_height);
+    plutofilter__box_blur(out, out, intermediate, kernel_width, kernel_height);
+    plutofilter__box_blur(out, out, intermediate, kernel_width, kernel_height);
+}
+
+static void plutofilter__copy_surface(plutofilter_surface_t in, plutofilter_surface_t out)
+{
+    if(in.pixels == out.pixels && in.stride == out.stride)
+        return;
+    for(int y = 0; y < out.height; y++) {
+        memmove(out.pixels + y * out.stride, in.pixels + y * in.stride, out.width * sizeof(uint32_t));
+    }
+}
+
+#define PLUTOFILTER_UNSHARP_CHANNEL(src, sum, k, amount, threshold) \
+    do { \
+        int __diff = (int)(src) - (int)((sum) / (k)); \
+        if(__diff > (threshold) || __diff < -(threshold)) { \
+            int __value = (int)(src) * 256 + __diff * (amount); \
+            (src) = __value <= 0 ? 0 : PLUTOFILTER_MIN((__value + 128) >> 8, 255); \
+        } \
+    } while(0)
+
+#define PLUTOFILTER_UNSHARP_STORE_PIXEL(in, out, x, y, r, g, b, a, k, amount, threshold) \
+    do { \
+        PLUTOFILTER_INIT_LOAD_PIXEL(in, x, y, __r, __g, __b, __a); \
+        PLUTOFILTER_UNSHARP_CHANNEL(__r, r, k, amount, threshold); \
+        PLUTOFILTER_UNSHARP_CHANNEL(__g, g, k, amount, threshold); \
+        PLUTOFILTER_UNSHARP_CHANNEL(__b, b, k, amount, threshold); \
+        PLUTOFILTER_UNSHARP_CHANNEL(__a, a, k, amount, threshold); \
+        PLUTOFILTER_STORE_PIXEL(out, x, y, PLUTOFILTER_MIN(__r, __a), PLUTOFILTER_MIN(__g, __a), PLUTOFILTER_MIN(__b, __a), __a); \
+    } while(0)
+
+// The last vertical pass of the blur, reading the blurred surface from `out` and combining each blurred
+// pixel with the matching pixel of `in` as soon as its window sum is complete.
+static void plutofilter__unsharp_sweep(plutofilter_surface_t in, plutofilter_surface_t out, uint32_t* intermediate, int kernel_height, int amount, int threshold)
+{
+    int x, y, offset;
+    uint32_t sample, r, g, b, a;
+    uint32_t sum_r, sum_g, sum_b, sum_a;
+
+    kernel_height = PLUTOFILTER_MIN(kernel_height, out.height);
+    for(x = 0; x < out.width; x++) {
+        sum_r = sum_g = sum_b = sum_a = 0;
+        for(y = 0; y < kernel_height; y++) {
+            sample = (intermediate[y % kernel_height] = PLUTOFILTER_GET_PIXEL(out, x, y));
+            PLUTOFILTER_UNPACK_PIXEL(sample, r, g, b, a);
+
+            sum_r += r;
+            sum_g += g;
+            sum_b += b;
+            sum_a += a;
+
+            offset = y - kernel_height / 2;
+            if(offset >= 0 && offset < out.height) {
+                PLUTOFILTER_UNSHARP_STORE_PIXEL(in, out, x, offset, sum_r, sum_g, sum_b, sum_a, kernel_height, amount, threshold);
+            }
+        }
+
+        for(y = kernel_height; y < out.height; y++) {
+            sample = intermediate[y % kernel_height];
+            PLUTOFILTER_UNPACK_PIXEL(sample, r, g, b, a);
+
+            sum_r -= r;
+            sum_g -= g;
+            sum_b -= b;
+            sum_a -= a;
+
+            sample = (intermediate[y % kernel_height] = PLUTOFILTER_GET_PIXEL(out, x, y));
+            PLUTOFILTER_UNPACK_PIXEL(sample, r, g, b, a);
+
+            sum_r += r;
+            sum_g += g;
+            sum_b += b;
+            sum_a += a;
+
+            offset = y - kernel_height / 2;
+            PLUTOFILTER_UNSHARP_STORE_PIXEL(in, out, x, offset, sum_r, sum_g, sum_b, sum_a, kernel_height, amount, threshold);
+        }
+
+        for(y = out.height; y < out.height + kernel_height; y++) {
+            sample = intermediate[y % kernel_height];
+            PLUTOFILTER_UNPACK_PIXEL(sample, r, g, b, a);
+
+            sum_r -= r;
+            sum_g -= g;
+            sum_b -= b;
+            sum_a -= a;
+
+            offset = y - kernel_height / 2;
+            if(offset >= 0 && offset < out.height) {
+                PLUTOFILTER_UNSHARP_STORE_PIXEL(in, out, x, offset, sum_r, sum_g, sum_b, sum_a, kernel_height, amount, threshold);
+            }
+        }
+    }
+}
+
+void plutofilter_unsharp_mask(plutofilter_surface_t in, plutofilter_surface_t out, float std_deviation, float amount, float threshold)
+{
+    PLUTOFILTER_OVERLAP_SURFACE(in, out);
+
+    int kernel_size = plutofilter__calc_kernel_size(std_deviation);
+    if(kernel_size <= 1 || amount == 0.f) {
+        plutofilter__copy_surface(in, out);
+        return;
+    }
+
+    if(kernel_size > PLUTOFILTER_MAX_KERNEL_SIZE)
+        kernel_size = PLUTOFILTER_MAX_KERNEL_SIZE;
+    const int fixed_amount = (int)(amount * 256.f + (amount < 0.f ? -0.5f : 0.5f));
+    const int fixed_threshold = (int)(PLUTOFILTER_CLAMP(threshold, 0.f, 1.f) * 255.f + 0.5f);
+
+    uint32_t intermediate[PLUTOFILTER_MAX_KERNEL_SIZE];
+
+    // Three box blurs approximate the Gaussian, as in plutofilter_gaussian_blur, with the final vertical
+    // pass replaced by the sweep that also sharpens.
+    plutofilter__box_blur(in, out, intermediate, kernel_size, 0);
+    plutofilter__box_blur(out, out, intermediate, 0, kernel_size);
+    plutofilter__box_blur(out, out, intermediate, kernel_size, kernel_size);
+    plutofilter__box_blur(out, out, intermediate, kernel_size, 0);
+    plutofilter__unsharp_sweep(in, out, intermediate, kernel_size, fixed_amount, fixed_threshold);
+}
+
+static int plutofilter__quantize_kernel(const float* kernel, int size, int* weights)
+{
+    float sum = 0.f;
+    float abs_sum = 0.f;
+    for(int i = 0; i < size; i++) {
+        sum += kernel[i];
+        abs_sum += fabsf(kernel[i]);
+    }
+
+    int shift = 14;
+    while(shift > 0 && 255.f * abs_sum * (float)(1 << shift) >= 2147483647.f / 2.f)
+        shift--;
+    const float scale = (float)(1 << shift);
+
+    int largest = 0;
+    int quantized_sum = 0;
+    for(int i = 0; i < size; i++) {
+        weights[i] = (int)(lroundf(kernel[i] * scale));
+        quantized_sum += weights[i];
+        if(abs(weights[i]) > abs(weights[largest])) {
+            largest = i;
+        }
+    }
+
+    weights[largest] += (int)(lroundf(sum * scale)) - quantized_sum;
+    return shift;
+}
+
+#define PLUTOFILTER_CONVOLVE_LANES 8
+#define PLUTOFILTER_CONVOLVE_CHUNK 32
+
+static inline uint32_t plutofilter__fetch_line(const uint32_t* line, size_t step, int length, int position, plutofilter_edge_mode_t edge_mode, const uint32_t* head, int lane)
+{
+    if(position >= 0 && position < length)
+        return line[position * step];
+    switch(edge_mode) {
+    case PLUTOFILTER_EDGE_MODE_DUPLICATE:
+        return line[(position < 0 ? 0 : length - 1) * step];
+    case PLUTOFILTER_EDGE_MODE_WRAP:
+        position %= length;
+        if(position < 0)
+            return line[(position + length) * step];
+        return head[position * PLUTOFILTER_CONVOLVE_LANES + lane];
+    default:
+        return 0;
+    }
+}
+
+/*
+ * Convolves up to PLUTOFILTER_CONVOLVE_LANES parallel lines of `length` pixels. `step` is the distance
+ * between consecutive pixels of a line and `pitch` the distance between adjacent lines, so the same
+ * routine walks rows (step 1) or columns (pitch 1). The lines are loaded into a transposed window
+ * whose inner dimension runs across lanes, which keeps the multiply-accumulate loop contiguous for
+ * both axes. The window only ever holds pixels that have not been written yet, or copies of them,
+ * so the source and destination lines may be the same.
+ */
+static void plutofilter__convolve_lines(const uint32_t* src, size_t src_step, size_t src_pitch, uint32_t* dst, size_t dst_step, size_t dst_pitch,
+                                        int length, int lanes, const int* weights, int size, int target, int shift, plutofilter_edge_mode_t edge_mode)
+{
+    uint32_t window[(PLUTOFILTER_MAX_KERNEL_SIZE - 1 + PLUTOFILTER_CONVOLVE_CHUNK) * PLUTOFILTER_CONVOLVE_LANES];
+    uint32_t head[(PLUTOFILTER_MAX_KERNEL_SIZE - 1) * PLUTOFILTER_CONVOLVE_LANES];
+    int32_t sums[PLUTOFILTER_CONVOLVE_LANES * 4];
+
+    if(edge_mode == PLUTOFILTER_EDGE_MODE_WRAP) {
+        int head_size = PLUTOFILTER_MIN(size - 1, length);
+        for(int i = 0; i < head_size; i++) {
+            for(int l = 0; l < lanes; l++) {
+                head[i * PLUTOFILTER_CONVOLVE_LANES + l] = src[i * src_step + l * src_pitch];
+            }
+        }
+    }
+
+    const int32_t rounding = shift > 0 ? 1 << (shift - 1) : 0;
+    int position = -target;
+    int loaded = 0;
+    for(int start = 0; start < length; start += PLUTOFILTER_CONVOLVE_CHUNK) {
+        int count = PLUTOFILTER_MIN(PLUTOFILTER_CONVOLVE_CHUNK, length - start);
+        for(; loaded < size - 1 + count; loaded++, position++) {
+            uint32_t* row = window + loaded * PLUTOFILTER_CONVOLVE_LANES;
+            for(int l = 0; l < PLUTOFILTER_CONVOLVE_LANES; l++) {
+                row[l] = l < lanes ? plutofilter__fetch_line(src + l * src_pitch, src_step, length, position, edge_mode, head, l) : 0;
+            }
+        }
+
+        for(int i = 0; i < count; i++) {
+            for(int l = 0; l < PLUTOFILTER_CONVOLVE_LANES * 4; l++)
+                sums[l] = rounding;
+            for(int k = 0; k < size; k++) {
+                const int32_t weight = weights[k];
+                if(weight == 0)
+                    continue;
+                const uint32_t* row = window + (i + k) * PLUTOFILTER_CONVOLVE_LANES;
+                for(int l = 0; l < PLUTOFILTER_CONVOLVE_LANES; l++) {
+                    sums[l * 4 + 0] += weight * (int32_t)PLUTOFILTER_RED(row[l]);
+                    sums[l * 4 + 1] += weight * (int32_t)PLUTOFILTER_GREEN(row[l]);
+                    sums[l * 4 + 2] += weight * (int32_t)PLUTOFILTER_BLUE(row[l]);
+                    sums[l * 4 + 3] += weight * (int32_t)PLUTOFILTER_ALPHA(row[l]);
+                }
+            }
+
+            uint32_t* pixels = dst + (start + i) * dst_step;
+            for(int l = 0; l < lanes; l++) {
+                int32_t a = PLUTOFILTER_MAX(sums[l * 4 + 3], 0) >> shift;
+                a = PLUTOFILTER_MIN(a, 255);
+                int32_t r = PLUTOFILTER_CLAMP(sums[l * 4 + 0], 0, a << shift) >> shift;
+                int32_t g = PLUTOFILTER_CLAMP(sums[l * 4 + 1], 0, a << shift) >> shift;
+                int32_t b = PLUTOFILTER_CLAMP(sums[l * 4 + 2], 0, a << shift) >> shift;
+                pixels[l * dst_pitch] = PLUTOFILTER_PACK_PIXEL(r, g, b, a);
+            }
+        }
+
+        loaded = size - 1;
+        memmove(window, window + count * PLUTOFILTER_CONVOLVE_LANES, loaded * PLUTOFILTER_CONVOLVE_LANES * sizeof(uint32_t));
+    }
+}
+
+static void plutofilter__convolve_separable(plutofilter_surface_t in, plutofilter_surface_t out, const float* kernel_x, int size_x, int target_x,
+                                            const float* kernel_y, int size_y, int target_y, plutofilter_edge_mode_t edge_mode)
+{
+    int weights[PLUTOFILTER_MAX_KERNEL_SIZE];
+    if(kernel_x && size_x > 0 && out.width > 0) {
+        int shift = plutofilter__quantize_kernel(kernel_x, size_x, weights);
+        for(int y = 0; y < out.height; y += PLUTOFILTER_CONVOLVE_LANES) {
+            int lanes = PLUTOFILTER_MIN(PLUTOFILTER_CONVOLVE_LANES, out.height - y);
+            plutofilter__convolve_lines(in.pixels + y * in.stride, 1, in.stride, out.pixels + y * out.stride, 1, out.stride,
+                                        out.width, lanes, weights, size_x, target_x, shift, edge_mode);
+        }
+
+        in = out;
+    }
+
+    if(kernel_y && size_y > 0 && out.height > 0) {
+        int shift = plutofilter__quantize_kernel(kernel_y, size_y, weights);
+        for(int x = 0; x < out.width; x += PLUTOFILTER_CONVOLVE_LANES) {
+            int lanes = PLUTOFILTER_MIN(PLUTOFILTER_CONVOLVE_LANES, out.width - x);
+            plutofilter__convolve_lines(in.pixels + x, in.stride, 1, out.pixels + x, out.stride, 1,
+                                        out.height, lanes, weights, size_y, target_y, shift, edge_mode);
+        }
+
+        in = out;
+    }
+
+    plutofilter__copy_surface(in, out);
+}
+
+void plutofilter_convolve_separable(plutofilter_surface_t in, plutofilter_surface_t out, const float* kernel_x, int size_x, const float* kernel_y, int size_y, plutofilter_edge_mode_t edge_mode)
+{
+    PLUTOFILTER_OVERLAP_SURFACE(in, out);
+
+    size_x = PLUTOFILTER_MIN(size_x, PLUTOFILTER_MAX_KERNEL_SIZE);
+    size_y = PLUTOFILTER_MIN(size_y, PLUTOFILTER_MAX_KERNEL_SIZE);
+    plutofilter__convolve_separable(in, out, kernel_x, size_x, size_x / 2, kernel_y, size_y, size_y / 2, edge_mode);
+}
+
+#define PLUTOFILTER_MAX_CONVOLVE_ORDER 32
+#define PLUTOFILTER_CONVOLVE_MATRIX_CHUNK 64
+
+/*
+ * Splits a flipped and normalized kernel into a horizontal factor whose taps sum to one and a vertical
+ * factor carrying the rest. The split is only accepted when both factors are non-negative and the vertical
+ * one does not amplify, so the 8-bit intermediate of the separable path stays within half a level of the
+ * direct result.
+ */
+static int plutofilter__factor_kernel(const float* kernel, int order_x, int order_y, float* kernel_x, float* kernel_y)
+{
+    int pivot = 0;
+    for(int i = 1; i < order_x * order_y; i++) {
+        if(fabsf(kernel[i]) > fabsf(kernel[pivot])) {
+            pivot = i;
+        }
+    }
+
+    const float pivot_value = kernel[pivot];
+    if(pivot_value == 0.f)
+        return 0;
+    const int pivot_x = pivot % order_x;
+    const int pivot_y = pivot / order_x;
+
+    float sum_x = 0.f;
+    for(int j = 0; j < order_x; j++) {
+        kernel_x[j] = kernel[pivot_y * order_x + j];
+        sum_x += kernel_x[j];
+    }
+
+    if(sum_x == 0.f)
+        return 0;
+    for(int i = 0; i < order_y; i++) {
+        kernel_y[i] = kernel[i * order_x + pivot_x] / pivot_value;
+    }
+
+    const float tolerance = fabsf(pivot_value) * 1e-5f;
+    for(int i = 0; i < order_y; i++) {
+        for(int j = 0; j < order_x; j++) {
+            if(fabsf(kernel[i * order_x + j] - kernel_y[i] * kernel_x[j]) > tolerance) {
+                return 0;
+            }
+        }
+    }
+
+    for(int j = 0; j < order_x; j++) {
+        kernel_x[j] /= sum_x;
+        if(kernel_x[j] < 0.f) {
+            return 0;
+        }
+    }
+
+    float sum_y = 0.f;
+    for(int i = 0; i < order_y; i++) {
+        kernel_y[i] *= sum_x;
+        if(kernel_y[i] < 0.f)
+            return 0;
+        sum_y += kernel_y[i];
+    }
+
+    return sum_y <= 1.0001f;
+}
+
+static inline uint32_t plutofilter__fetch_pixel(plutofilter_surface_t in, int x, int y, plutofilter_edge_mode_t edge_mode)
+{
+    if(x < 0 || x >= in.width || y < 0 || y >= in.height) {
+        switch(edge_mode) {
+        case PLUTOFILTER_EDGE_MODE_DUPLICATE:
+            x = PLUTOFILTER_CLAMP(x, 0, in.width - 1);
+            y = PLUTOFILTER_CLAMP(y, 0, in.height - 1);
+            break;
+        case PLUTOFILTER_EDGE_MODE_WRAP:
+            x %= in.width;
+            y %= in.height;
+            if(x < 0) x += in.width;
+            if(y < 0) y += in.height;
+            break;
+        default:
+            return 0;
+        }
+    }
+
+    return PLUTOFILTER_GET_PIXEL(in, x, y);
+}
+
+void plutofilter_convolve_matrix(plutofilter_surface_t in, plutofilter_surface_t out, int order_x, int order_y, const float* kernel,
+                                 float divisor, float bias, int target_x, int target_y, plutofilter_edge_mode_t edge_mode, int preserve_alpha)
+{
+    PLUTOFILTER_OVERLAP_SURFACE(in, out);
+    if(order_x <= 0 || order_y <= 0 || order_x > PLUTOFILTER_MAX_CONVOLVE_ORDER || order_y > PLUTOFILTER_MAX_CONVOLVE_ORDER
+       || target_x < 0 || target_x >= order_x || target_y < 0 || target_y >= order_y || out.width == 0) {
+        plutofilter__copy_surface(in, out);
+        return;
+    }
+
+    float weights[PLUTOFILTER_MAX_CONVOLVE_ORDER * PLUTOFILTER_MAX_CONVOLVE_ORDER];
+    if(divisor == 0.f) {
+        for(int i = 0; i < order_x * order_y; i++)
+            divisor += kernel[i];
+        if(divisor == 0.f) {
+            divisor = 1.f;
+        }
+    }
+
+    for(int i = 0; i < order_y; i++) {
+        for(int j = 0; j < order_x; j++) {
+            weights[i * order_x + j] = kernel[(order_y - 1 - i) * order_x + (order_x - 1 - j)] / divisor;
+        }
+    }
+
+    if(bias == 0.f && !preserve_alpha) {
+        float kernel_x[PLUTOFILTER_MAX_CONVOLVE_ORDER];
+        float kernel_y[PLUTOFILTER_MAX_CONVOLVE_ORDER];
+        if(plutofilter__factor_kernel(weights, order_x, order_y, kernel_x, kernel_y)) {
+            plutofilter__convolve_separable(in, out, kernel_x, order_x, target_x, kernel_y, order_y, target_y, edge_mode);
+            return;
+        }
+    }
+
+    int fixed_weights[PLUTOFILTER_MAX_CONVOLVE_ORDER * PLUTOFILTER_MAX_CONVOLVE_ORDER];
+    const int shift = plutofilter__quantize_kernel(weights, order_x * order_y, fixed_weights);
+    const int32_t initial = (int32_t)(lroundf(PLUTOFILTER_CLAMP(bias, -1.f, 1.f) * 255.f * (float)(1 << shift))) + (shift > 0 ? 1 << (shift - 1) : 0);
+
+    int32_t sums[4][PLUTOFILTER_CONVOLVE_MATRIX_CHUNK];
+    int32_t line[4][PLUTOFILTER_CONVOLVE_MATRIX_CHUNK + PLUTOFILTER_MAX_CONVOLVE_ORDER - 1];
+    const int channels = preserve_alpha ? 3 : 4;
+    for(int y = 0; y < out.height; y++) {
+        for(int x0 = 0; x0 < out.width; x0 += PLUTOFILTER_CONVOLVE_MATRIX_CHUNK) {
+            const int count = PLUTOFILTER_MIN(PLUTOFILTER_CONVOLVE_MATRIX_CHUNK, out.width - x0);
+            for(int c = 0; c < 4; c++) {
+                for(int k = 0; k < count; k++) {
+                    sums[c][k] = initial;
+                }
+            }
+
+            for(int i = 0; i < order_y; i++) {
+                const int sy = y - target_y + i;
+                if(edge_mode == PLUTOFILTER_EDGE_MODE_NONE && (sy < 0 || sy >= in.height))
+                    continue;
+                for(int k = 0; k < count + order_x - 1; k++) {
+                    uint32_t r, g, b, a;
+                    uint32_t pixel = plutofilter__fetch_pixel(in, x0 - target_x + k, sy, edge_mode);
+                    PLUTOFILTER_UNPACK_PIXEL(pixel, r, g, b, a);
+                    if(preserve_alpha) {
+                        PLUTOFILTER_UNPREMULTIPLY_PIXEL(r, g, b, a);
+                    }
+
+                    line[0][k] = r;
+                    line[1][k] = g;
+                    line[2][k] = b;
+                    line[3][k] = a;
+                }
+
+                const int* row_weights = fixed_weights + i * order_x;
+                for(int c = 0; c < channels; c++) {
+                    int32_t* sum = sums[c];
+                    const int32_t* src = line[c];
+                    if(order_x == 3) {
+                        const int32_t w0 = row_weights[0];
+                        const int32_t w1 = row_weights[1];
+                        const int32_t w2 = row_weights[2];
+                        for(int k = 0; k < count; k++) {
+                            sum[k] += w0 * src[k] + w1 * src[k + 1] + w2 * src[k + 2];
+                        }
+                    } else {
+                        for(int j = 0; j < order_x; j++) {
+                            const int32_t weight = row_weights[j];
+                            if(weight == 0)
+                                continue;
+                            for(int k = 0; k < count; k++) {
+                                sum[k] += weight * src[k + j];
+                            }
+                        }
+                    }
+                }
+            }
+
+            for(int k = 0; k < count; k++) {
+                const int x = x0 + k;
+                uint32_t r, g, b, a;
+                if(preserve_alpha) {
+                    a = PLUTOFILTER_ALPHA(PLUTOFILTER_GET_PIXEL(in, x, y));
+                    r = PLUTOFILTER_CLAMP(sums[0][k], 0, 255 << shift) >> shift;
+                    g = PLUTOFILTER_CLAMP(sums[1][k], 0, 255 << shift) >> shift;
+                    b = PLUTOFILTER_CLAMP(sums[2][k], 0, 255 << shift) >> shift;
+                    PLUTOFILTER_PREMULTIPLY_PIXEL(r, g, b, a);
+                } else {
+                    a = PLUTOFILTER_CLAMP(sums[3][k], 0, 255 << shift) >> shift;
+                    r = PLUTOFILTER_CLAMP(sums[0][k], 0, (int32_t)(a << shift)) >> shift;
+                    g = PLUTOFILTER_CLAMP(sums[1][k], 0, (int32_t)(a << shift)) >> shift;
+                    b = PLUTOFILTER_CLAMP(sums[2][k], 0, (int32_t)(a << shift)) >> shift;
+                }
+
+                PLUTOFILTER_STORE_PIXEL(out, x, y, r, g, b, a);
+            }
+        }
+    }
+}
+
+static inline void plutofilter__morphology_span(uint8_t* dst, const uint8_t* src1, const uint8_t* src2, int dilate)
+{
+    if(dilate) {
+        for(int i = 0; i < PLUTOFILTER_CONVOLVE_LANES * 4; i++) {
+            dst[i] = PLUTOFILTER_MAX(src1[i], src2[i]);
+        }
+    } else {
+        for(int i = 0; i < PLUTOFILTER_CONVOLVE_LANES * 4; i++) {
+            dst[i] = PLUTOFILTER_MIN(src1[i], src2[i]);
+        }
+    }
+}
+
+/*
+ * van Herk/Gil-Werman running min/max over up to PLUTOFILTER_CONVOLVE_LANES parallel lines. The padded
+ * line is split into blocks as long as the window, so every window covers the suffix of one block and
+ * the prefix of the next. Each block is loaded once and scanned forward and backward, which costs
+ * about three comparisons per pixel whatever the radius. Outputs of a block are only written once the
+ * following block has been loaded, so the source and destination lines may be the same.
+ */
+static void plutofilter__morphology_lines(const uint32_t* src, size_t src_step, size_t src_pitch, uint32_t* dst, size_t dst_step, size_t dst_pitch,
+                                          int length, int lanes, int radius, int dilate)
+{
+    enum { span = PLUTOFILTER_CONVOLVE_LANES * 4 };
+    uint8_t block[(PLUTOFILTER_MAX_KERNEL_SIZE + 1) * span];
+    uint8_t suffix1[(PLUTOFILTER_MAX_KERNEL_SIZE + 1) * span];
+    uint8_t suffix2[(PLUTOFILTER_MAX_KERNEL_SIZE + 1) * span];
+
+    uint8_t* previous = suffix1;
+    uint8_t* current = suffix2;
+
+    const int size = 2 * radius + 1;
+    const int count = (length - 1) / size + 2;
+    for(int index = 0; index < count; index++) {
+        for(int t = 0; t < size; t++) {
+            int position = PLUTOFILTER_CLAMP(index * size + t - radius, 0, length - 1);
+            uint8_t* channels = block + t * span;
+            for(int l = 0; l < PLUTOFILTER_CONVOLVE_LANES; l++) {
+                uint32_t pixel = l < lanes ? src[position * src_step + l * src_pitch] : 0;
+                channels[l * 4 + 0] = PLUTOFILTER_RED(pixel);
+                channels[l * 4 + 1] = PLUTOFILTER_GREEN(pixel);
+                channels[l * 4 + 2] = PLUTOFILTER_BLUE(pixel);
+                channels[l * 4 + 3] = PLUTOFILTER_ALPHA(pixel);
+            }
+        }
+
+        memcpy(current + (size - 1) * span, block + (size - 1) * span, span);
+        for(int t = size - 2; t >= 0; t--)
+            plutofilter__morphology_span(current + t * span, current + (t + 1) * span, block + t * span, dilate);
+        for(int t = 1; t < size; t++) {
+            plutofilter__morphology_span(block + t * span, block + (t - 1) * span, block + t * span, dilate);
+        }
+
+        if(index > 0) {
+            for(int t = 0; t < size; t++) {
+                int position = (index - 1) * size + t;
+                if(position >= length)
+                    break;
+                uint8_t channels[span];
+                if(t == 0) {
+                    memcpy(channels, previous, span);
+                } else {
+                    plutofilter__morphology_span(channels, previous + t * span, block + (t - 1) * span, dilate);
+                }
+
+                uint32_t* pixels = dst + position * dst_step;
+                for(int l = 0; l < lanes; l++) {
+                    pixels[l * dst_pitch] = PLUTOFILTER_PACK_PIXEL(channels[l * 4 + 0], channels[l * 4 + 1], channels[l * 4 + 2], channels[l * 4 + 3]);
+                }
+            }
+        }
+
+        uint8_t* swap = previous;
+        previous = current;
+        current = swap;
+    }
+}
+
+void plutofilter_morphology(plutofilter_surface_t in, plutofilter_surface_t out, plutofilter_morphology_operator_t op, int radius_x, int radius_y)
+{
+    PLUTOFILTER_OVERLAP_SURFACE(in, out);
+
+    const int dilate = op == PLUTOFILTER_MORPHOLOGY_OPERATOR_DILATE;
+    if(radius_x > 0 && out.width > 0) {
+        radius_x = PLUTOFILTER_MIN(radius_x, PLUTOFILTER_MAX_KERNEL_SIZE / 2);
+        for(int y = 0; y < out.height; y += PLUTOFILTER_CONVOLVE_LANES) {
+            int lanes = PLUTOFILTER_MIN(PLUTOFILTER_CONVOLVE_LANES, out.height - y);
+            plutofilter__morphology_lines(in.pixels + y * in.stride, 1, in.stride, out.pixels + y * out.stride, 1, out.stride,
+                                          out.width, lanes, radius_x, dilate);
+        }
+
+        in = out;
+    }
+
+    if(radius_y > 0 && out.height > 0) {
+        radius_y = PLUTOFILTER_MIN(radius_y, PLUTOFILTER_MAX_KERNEL_SIZE / 2);
+        for(int x = 0; x < out.width; x += PLUTOFILTER_CONVOLVE_LANES) {
+            int lanes = PLUTOFILTER_MIN(PLUTOFILTER_CONVOLVE_LANES, out.width - x);
+            plutofilter__morphology_lines(in.pixels + x, in.stride, 1, out.pixels + x, out.stride, 1,
+                                          out.height, lanes, radius_y, dilate);
+        }
+
+        in = out;
+    }
+
+    plutofilter__copy_surface(in, out);
+}
+
+#define PLUTOFILTER_DISTANCE_INFINITY 0xFFFF
+
+static inline int64_t plutofilter__parabola(int x, uint32_t entry)
+{
+    int64_t dx = x - (int64_t)(entry >> 16);
+    int64_t dy = entry & 0xFFFF;
+    return dx * dx + dy * dy;
+}
+
+static inline int64_t plutofilter__parabola_separation(uint32_t entry1, uint32_t entry2)
+{
+    int64_t i = entry1 >> 16;
+    int64_t u = entry2 >> 16;
+    int64_t gi = entry1 & 0xFFFF;
+    int64_t gu = entry2 & 0xFFFF;
+    return (u * u - i * i + gu * gu - gi * gi) / (2 * (u - i));
+}
+
+static inline int64_t plutofilter__parabola_start(const uint32_t* entries, int index)
+{
+    return index > 0 ? 1 + plutofilter__parabola_separation(entries[index - 1], entries[index]) : 0;
+}
+
+/*
+ * Replaces each pixel of `out` with the squared Euclidean distance from the nearest pixel of `in` whose
+ * alpha is at least 128. The first pass scans the columns for the vertical distance to the shape, which
+ * walks the rows in order. The second pass takes the lower envelope of the parabolas (x - i)^2 + g(i)^2
+ * along each row. The envelope stack never has more entries than the pixels already read, so it is kept
+ * in the row itself, each entry packing the column and vertical distance of one parabola into 32 bits.
+ */
+static void plutofilter__distance_transform(plutofilter_surface_t in, plutofilter_surface_t out)
+{
+    for(int y = 0; y < out.height; y++) {
+        uint32_t* row = out.pixels + y * out.stride;
+        const uint32_t* above = y > 0 ? row - out.stride : NULL;
+        for(int x = 0; x < out.width; x++) {
+            if(PLUTOFILTER_ALPHA(PLUTOFILTER_GET_PIXEL(in, x, y)) >= 128) {
+                row[x] = 0;
+            } else if(above) {
+                row[x] = PLUTOFILTER_MIN(above[x] + 1, PLUTOFILTER_DISTANCE_INFINITY);
+            } else {
+                row[x] = PLUTOFILTER_DISTANCE_INFINITY;
+            }
+        }
+    }
+
+    for(int y = out.height - 2; y >= 0; y--) {
+        uint32_t* row = out.pixels + y * out.stride;
+        const uint32_t* below = row + out.stride;
+        for(int x = 0; x < out.width; x++) {
+            row[x] = PLUTOFILTER_MIN(row[x], below[x] + 1);
+        }
+    }
+
+    const int width = out.width;
+    if(width == 0)
+        return;
+    for(int y = 0; y < out.height; y++) {
+        uint32_t* row = out.pixels + y * out.stride;
+        int top = 0;
+        for(int u = 1; u < width; u++) {
+            const uint32_t entry = ((uint32_t)u << 16) | row[u];
+            while(top >= 0) {
+                int64_t start = plutofilter__parabola_start(row, top);
+                if(plutofilter__parabola(start, row[top]) <= plutofilter__parabola(start, entry))
+                    break;
+                top--;
+            }
+
+            if(top < 0) {
+                row[++top] = entry;
+            } else if(1 + plutofilter__parabola_separation(row[top], entry) < width) {
+                row[++top] = entry;
+            }
+        }
+
+        uint32_t entry = row[top];
+        int64_t start = plutofilter__parabola_start(row, top);
+        for(int u = width - 1; u >= 0; u--) {
+            int64_t distance = plutofilter__parabola(u, entry);
+            row[u] = (uint32_t)PLUTOFILTER_MIN(distance, (int64_t)UINT32_MAX);
+            if(u == start && top > 0) {
+                entry = row[--top];
+                start = plutofilter__parabola_start(row, top);
+            }
+        }
+    }
+}
+
+void plutofilter_distance_transform(plutofilter_surface_t in, plutofilter_surface_t out, float max_distance)
+{
+    PLUTOFILTER_OVERLAP_SURFACE(in, out);
+    plutofilter__distance_transform(in, out);
+
+    const float scale = max_distance > 0.f ? 255.f / max_distance : 0.f;
+    for(int y = 0; y < out.height; y++) {
+        for(int x = 0; x < out.width; x++) {
+            uint32_t distance = PLUTOFILTER_GET_PIXEL(out, x, y);
+            float a = distance ? 255.f : 0.f;
+            if(distance && scale > 0.f)
+                a = sqrtf((float)distance) * scale + 0.5f;
+            PLUTOFILTER_STORE_PIXEL(out, x, y, 0, 0, 0, PLUTOFILTER_CLAMP_PIXEL(a));
+        }
+    }
+}
+
+void plutofilter_distance_outline(plutofilter_surface_t in, plutofilter_surface_t out, float width)
+{
+    PLUTOFILTER_OVERLAP_SURFACE(in, out);
+    plutofilter__distance_transform(in, out);
+
+    const float limit = (width + 1.f) * (width + 1.f);
+    for(int y = 0; y < out.height; y++) {
+        for(int x = 0; x < out.width; x++) {
+            uint32_t distance = PLUTOFILTER_GET_PIXEL(out, x, y);
+            uint32_t a = PLUTOFILTER_ALPHA(PLUTOFILTER_GET_PIXEL(in, x, y));
+            if(distance < limit) {
+                float coverage = (width + 1.f - sqrtf((float)distance)) * 255.f + 0.5f;
+                a = PLUTOFILTER_MAX(a, (uint32_t)PLUTOFILTER_CLAMP_PIXEL(coverage));
+            }
+
+            PLUTOFILTER_STORE_PIXEL(out, x, y, 0, 0, 0, a);
+        }
+    }
+}
+
+void plutofilter_distance_glow(plutofilter_surface_t in, plutofilter_surface_t out, float radius)
+{
+    PLUTOFILTER_OVERLAP_SURFACE(in, out);
+    plutofilter__distance_transform(in, out);
+
+    const float limit = (radius + 0.5f) * (radius + 0.5f);
+    for(int y = 0; y < out.height; y++) {
+        for(int x = 0; x < out.width; x++) {
+            uint32_t distance = PLUTOFILTER_GET_PIXEL(out, x, y);
+            uint32_t a = PLUTOFILTER_ALPHA(PLUTOFILTER_GET_PIXEL(in, x, y));
+            if(distance < limit) {
+                float t = PLUTOFILTER_MIN(1.f, 1.f - (sqrtf((float)distance) - 0.5f) / radius);
+                float glow = t * t * (3.f - 2.f * t) * 255.f + 0.5f;
+                a = PLUTOFILTER_MAX(a, (uint32_t)PLUTOFILTER_CLAMP_PIXEL(glow));
+            }
+
+            PLUTOFILTER_STORE_PIXEL(out, x, y, 0, 0, 0, a);
+        }
+    }
+}
+
+void plutofilter_summed_area_table(plutofilter_surface_t in, uint32_t* table)
+{
+    const size_t pitch = 4 * ((size_t)(in.width) + 1);
+    memset(table, 0, pitch * sizeof(uint32_t));
+    for(int y = 0; y < in.height; y++) {
+        const uint32_t* above = table + y * pitch;
+        uint32_t* row = table + (y + 1) * pitch;
+        uint32_t sum_r = 0, sum_g = 0, sum_b = 0, sum_a = 0;
+        row[0] = row[1] = row[2] = row[3] = 0;
+        for(int x = 0; x < in.width; x++) {
+            PLUTOFILTER_INIT_LOAD_PIXEL(in, x, y, r, g, b, a);
+            sum_r += r;
+            sum_g += g;
+            sum_b += b;
+            sum_a += a;
+
+            row[4 * x + 4] = sum_r;
+            row[4 * x + 5] = sum_g;
+            row[4 * x + 6] = sum_b;
+            row[4 * x + 7] = sum_a;
+        }
+
+        for(size_t i = 4; i < pitch; i++) {
+            row[i] += above[i];
+        }
+    }
+}
+
+#define PLUTOFILTER_MAX_VARIABLE_BLUR_RADIUS 2047
+#define PLUTOFILTER_VARIABLE_BLUR_TENT_STEPS 4
+
+static inline void plutofilter__box_average(const uint32_t* table, size_t pitch, int width, int height, int x, int y, int radius, float weight, float* sums)
+{
+    const int x0 = PLUTOFILTER_MAX(x - radius, 0);
+    const int y0 = PLUTOFILTER_MAX(y - radius, 0);
+    const int x1 = PLUTOFILTER_MIN(x + radius + 1, width);
+    const int y1 = PLUTOFILTER_MIN(y + radius + 1, height);
+
+    const uint32_t* top = table + y0 * pitch;
+    const uint32_t* bottom = table + y1 * pitch;
+    const float scale = weight / (float)((x1 - x0) * (y1 - y0));
+    for(int c = 0; c < 4; c++) {
+        uint32_t sum = bottom[4 * x1 + c] - bottom[4 * x0 + c] - top[4 * x1 + c] + top[4 * x0 + c];
+        sums[c] += (float)sum * scale;
+    }
+}
+
+void plutofilter_variable_blur(plutofilter_surface_t in, plutofilter_surface_t radius_map, plutofilter_surface_t out, float max_radius, plutofilter_variable_blur_filter_t filter, uint32_t* table)
+{
+    PLUTOFILTER_OVERLAP_SURFACE3(in, radius_map, out);
+    plutofilter_summed_area_table(in, table);
+
+    const size_t pitch = 4 * ((size_t)(in.width) + 1);
+    const float scale = PLUTOFILTER_CLAMP(max_radius, 0.f, (float)PLUTOFILTER_MAX_VARIABLE_BLUR_RADIUS) / 255.f;
+    const int steps = filter == PLUTOFILTER_VARIABLE_BLUR_FILTER_TENT ? PLUTOFILTER_VARIABLE_BLUR_TENT_STEPS : 1;
+    for(int y = 0; y < out.height; y++) {
+        for(int x = 0; x < out.width; x++) {
+            const float radius = PLUTOFILTER_ALPHA(PLUTOFILTER_GET_PIXEL(radius_map, x, y)) * scale;
+            float sums[4] = {0.f, 0.f, 0.f, 0.f};
+            for(int step = 1; step <= steps; step++) {
+                const float step_radius = radius * step / steps;
+                const int radius0 = (int)step_radius;
+                const float fraction = step_radius - radius0;
+                const float weight = 1.f / steps;
+
+                plutofilter__box_average(table, pitch, out.width, out.height, x, y, radius0, weight * (1.f - fraction), sums);
+                if(fraction > 0.f) {
+                    plutofilter__box_average(table, pitch, out.width, out.height, x, y, radius0 + 1, weight * fraction, sums);
+                }
+            }
+
+            uint32_t a = (uint32_t)(sums[3] + 0.5f);
+            uint32_t r = PLUTOFILTER_MIN((uint32_t)(sums[0] + 0.5f), a);
+            uint32_t g = PLUTOFILTER_MIN((uint32_t)(sums[1] + 0.5f), a);
+            uint32_t b = PLUTOFILTER_MIN((uint32_t)(sums[2] + 0.5f), a);
+            PLUTOFILTER_STORE_PIXEL(out, x, y, r, g, b, a);
+        }
+    }
+}
+
+static inline int plutofilter__line_offset(int step, double slope)
+{
+    return (int)floor(step * slope + 0.5);
+}
+
+static int plutofilter__line_search(int length, double slope, int target)
+{
+    int lo = 0, hi = length;
+    while(lo < hi) {
+        int mid = lo + (hi - lo) / 2;
+        if(plutofilter__line_offset(mid, slope) < target) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+
+    return lo;
+}
+
+static void plutofilter__line_blur(plutofilter_surface_t in, plutofilter_surface_t out, uint32_t* intermediate, float angle, float kernel_size)
+{
+    const double radians = angle * 3.14159265358979323846 / 180.0;
+    double dx = cos(radians);
+    double dy = sin(radians);
+
+    const int x_major = fabs(dx) >= fabs(dy);
+    const double slope = x_major ? dy / dx : dx / dy;
+    const int reversed = slope < 0.0;
+    const double step_slope = fabs(slope);
+
+    const int length = x_major ? out.width : out.height;
+    const int breadth = x_major ? out.height : out.width;
+
+    // Steps along the line are longer than one pixel unless it is axis-aligned.
+    const float steps = PLUTOFILTER_MIN(kernel_size / (float)sqrt(1.0 + step_slope * step_slope), (float)(PLUTOFILTER_MAX_KERNEL_SIZE - 2));
+    if(steps <= 1.f) {
+        plutofilter__copy_surface(in, out);
+        return;
+    }
+
+    const float half = (steps - 1.f) * 0.5f;
+    const int radius = (int)half;
+    const uint32_t edge = (uint32_t)((half - radius) * 256.f + 0.5f);
+    const uint32_t divisor = 256 * (2 * radius + 1) + 2 * edge;
+    const int ring_size = 2 * radius + 3;
+
+    const int last_offset = plutofilter__line_offset(length - 1, step_slope);
+    for(int line = -last_offset; line < breadth; line++) {
+        const int start = plutofilter__line_search(length, step_slope, -line);
+        const int end = plutofilter__line_search(length, step_slope, breadth - line);
+        if(start >= end)
+            continue;
+        memset(intermediate, 0, ring_size * sizeof(uint32_t));
+
+        uint32_t sum_r = 0, sum_g = 0, sum_b = 0, sum_a = 0;
+        uint32_t r, g, b, a;
+        for(int i = 0; start + i < end + radius + 1; i++) {
+            uint32_t trailing = intermediate[(i + 1) % ring_size];
+            uint32_t previous = intermediate[(i + ring_size - 1) % ring_size];
+            uint32_t leading = 0;
+
+            int step = start + i;
+            if(step < end) {
+                int major = reversed ? length - 1 - step : step;
+                int minor = line + plutofilter__line_offset(step, step_slope);
+                leading = x_major ? PLUTOFILTER_GET_PIXEL(in, major, minor) : PLUTOFILTER_GET_PIXEL(in, minor, major);
+            }
+
+            intermediate[i % ring_size] = leading;
+
+            PLUTOFILTER_UNPACK_PIXEL(previous, r, g, b, a);
+            sum_r += r;
+            sum_g += g;
+            sum_b += b;
+            sum_a += a;
+
+            PLUTOFILTER_UNPACK_PIXEL(trailing, r, g, b, a);
+            sum_r -= r;
+            sum_g -= g;
+            sum_b -= b;
+            sum_a -= a;
+
+            step -= radius + 1;
+            if(step < start)
+                continue;
+            uint32_t edge_r = r, edge_g = g, edge_b = b, edge_a = a;
+            PLUTOFILTER_UNPACK_PIXEL(leading, r, g, b, a);
+            edge_r += r;
+            edge_g += g;
+            edge_b += b;
+            edge_a += a;
+
+            r = (256 * sum_r + edge * edge_r) / divisor;
+            g = (256 * sum_g + edge * edge_g) / divisor;
+            b = (256 * sum_b + edge * edge_b) / divisor;
+            a = (256 * sum_a + edge * edge_a) / divisor;
+
+            int major = reversed ? length - 1 - step : step;
+            int minor = line + plutofilter__line_offset(step, step_slope);
+            if(x_major) {
+                PLUTOFILTER_STORE_PIXEL(out, major, minor, r, g, b, a);
+            } else {
+                PLUTOFILTER_STORE_PIXEL(out, minor, major, r, g, b, a);
+            }
+        }
+    }
+}
+
+void plutofilter_motion_blur(plutofilter_surface_t in, plutofilter_surface_t out, float angle, float distance)
+{
+    PLUTOFILTER_OVERLAP_SURFACE(in, out);
+
+    uint32_t intermediate[PLUTOFILTER_MAX_KERNEL_SIZE];
+    plutofilter__line_blur(in, out, intermediate, angle, distance);
+}
+
+void plutofilter_directional_blur(plutofilter_surface_t in, plutofilter_surface_t out, float angle, float std_deviation)
+{
+    PLUTOFILTER_OVERLAP_SURFACE(in, out);
+
+    uint32_t intermediate[PLUTOFILTER_MAX_KERNEL_SIZE];
+    const float kernel_size = std_deviation * PLUTOFILTER_KERNEL_FACTOR;
+    plutofilter__line_blur(in, out, intermediate, angle, kernel_size);
+    plutofilter__line_blur(out, out, intermediate, angle, kernel_size);
+    plutofilter__line_blur(out, out, intermediate, angle, kernel_size);
+}
+
+static inline uint32_t plutofilter__srgb_to_linear_rgb_pixel(uint32_t pixel)
+{
+    uint32_t r, g, b, a;
+    PLUTOFILTER_UNPACK_PIXEL(pixel, r, g, b, a);
+    if(a == 255) {
+        PLUTOFILTER_SRGB_TO_LINEAR_RGB(r, g, b);
+        return PLUTOFILTER_PACK_PIXEL(r, g, b, a);
+    }
+
+    PLUTOFILTER_UNPREMULTIPLY_PIXEL(r, g, b, a);
+    PLUTOFILTER_SRGB_TO_LINEAR_RGB(r, g, b);
+    PLUTOFILTER_PREMULTIPLY_PIXEL(r, g, b, a);
+    return PLUTOFILTER_PACK_PIXEL(r, g, b, a);
+}
+
+static inline uint32_t plutofilter__linear_rgb_to_srgb_pixel(uint32_t pixel)
+{
+    uint32_t r, g, b, a;
+    PLUTOFILTER_UNPACK_PIXEL(pixel, r, g, b, a);
+    if(a == 255) {
+        PLUTOFILTER_LINEAR_RGB_TO_SRGB(r, g, b);
+        return PLUTOFILTER_PACK_PIXEL(r, g, b, a);
+    }
+
+    PLUTOFILTER_UNPREMULTIPLY_PIXEL(r, g, b, a);
+    PLUTOFILTER_LINEAR_RGB_TO_SRGB(r, g, b);
+    PLUTOFILTER_PREMULTIPLY_PIXEL(r, g, b, a);
+    return PLUTOFILTER_PACK_PIXEL(r, g, b, a);
+}
+
+// Channels are summed two at a time in 16-bit lanes of a 32-bit word: alpha and green in one, red and blue in
+// the other. A weighted sum of up to 64 * 255 still fits in a lane.
+#define PLUTOFILTER_DOWNSAMPLE_LANES 0x00FF00FFu
+
+#define PLUTOFILTER_DOWNSAMPLE_ACCUMULATE(pixel, weight, sum_ag, sum_rb) \
+    do { \
+        (sum_ag) += (((pixel) >> 8) & PLUTOFILTER_DOWNSAMPLE_LANES) * (weight); \
+        (sum_rb) += ((pixel) & PLUTOFILTER_DOWNSAMPLE_LANES) * (weight); \
     } while(0)
 
-#define PLUTOFILTER_UNPREMULTIPLY_PIXEL(r, g, b, a) \
-    do { \
-        if((a)) { \
-            (r) = (255 * (r)) / (a); \
-            (g) = (255 * (g)) / (a); \
-            (b) = (255 * (b)) / (a); \
-        } else { \
-            (r) = (g) = (b) = 0; \
-        } \
-    } while(0)
+#define PLUTOFILTER_DOWNSAMPLE_RESOLVE(sum_ag, sum_rb, shift) \
+    (((((sum_ag) + (0x00010001u << ((shift) - 1))) >> (shift)) & PLUTOFILTER_DOWNSAMPLE_LANES) << 8 \
+        | ((((sum_rb) + (0x00010001u << ((shift) - 1))) >> (shift)) & PLUTOFILTER_DOWNSAMPLE_LANES))
+
+static inline uint32_t plutofilter__downsample_tap(const uint32_t* row, int x, int linear)
+{
+    return linear ? plutofilter__srgb_to_linear_rgb_pixel(row[x]) : row[x];
+}
+
+void plutofilter_downsample_2x(plutofilter_surface_t in, plutofilter_surface_t out, plutofilter_downsample_filter_t filter, plutofilter_color_space_t color_space)
+{
+    if(in.width == 0 || in.height == 0)
+        return;
+    const int width = PLUTOFILTER_MIN(out.width, (in.width + 1) / 2);
+    const int height = PLUTOFILTER_MIN(out.height, (in.height + 1) / 2);
+    const int linear = color_space == PLUTOFILTER_COLOR_SPACE_LINEAR_RGB;
+
+    if(filter == PLUTOFILTER_DOWNSAMPLE_FILTER_TENT) {
+        static const uint32_t weights[4] = {1, 3, 3, 1};
+        for(int y = 0; y < height; y++) {
+            const uint32_t* rows[4];
+            for(int j = 0; j < 4; j++) {
+                const int row = PLUTOFILTER_CLAMP(2 * y - 1 + j, 0, in.height - 1);
+                rows[j] = in.pixels + row * in.stride;
+            }
+
+            // Vertical sums of the two rightmost columns of a window are the two leftmost of the next one.
+            uint32_t column_ag[4], column_rb[4];
+            for(int i = 0; i < 4; i++) {
+                column_ag[i] = column_rb[i] = 0;
+                if(i < 2) {
+                    const int column = PLUTOFILTER_MAX(i - 1, 0);
+                    for(int j = 0; j < 4; j++) {
+                        const uint32_t pixel = plutofilter__downsample_tap(rows[j], column, linear);
+                        PLUTOFILTER_DOWNSAMPLE_ACCUMULATE(pixel, weights[j], column_ag[i], column_rb[i]);
+                    }
+                }
+            }
+
+            for(int x = 0; x < width; x++) {
+                for(int i = 2; i < 4; i++) {
+                    const int column = PLUTOFILTER_MIN(2 * x - 1 + i, in.width - 1);
+                    column_ag[i] = column_rb[i] = 0;
+                    for(int j = 0; j < 4; j++) {
+                        const uint32_t pixel = plutofilter__downsample_tap(rows[j], column, linear);
+                        PLUTOFILTER_DOWNSAMPLE_ACCUMULATE(pixel, weights[j], column_ag[i], column_rb[i]);
+                    }
+                }
+
+                uint32_t sum_ag = 0, sum_rb = 0;
+                for(int i = 0; i < 4; i++) {
+                    sum_ag += column_ag[i] * weights[i];
+                    sum_rb += column_rb[i] * weights[i];
+                }
+
+                column_ag[0] = column_ag[2];
+                column_rb[0] = column_rb[2];
+                column_ag[1] = column_ag[3];
+                column_rb[1] = column_rb[3];
+
+                const uint32_t pixel = PLUTOFILTER_DOWNSAMPLE_RESOLVE(sum_ag, sum_rb, 6);
+                out.pixels[y * out.stride + x] = linear ? plutofilter__linear_rgb_to_srgb_pixel(pixel) : pixel;
+            }
+        }
+    } else {
+        for(int y = 0; y < height; y++) {
+            const uint32_t* row0 = in.pixels + (2 * y) * in.stride;
+            const uint32_t* row1 = in.pixels + PLUTOFILTER_MIN(2 * y + 1, in.height - 1) * in.stride;
+            for(int x = 0; x < width; x++) {
+                const int x0 = 2 * x;
+                const int x1 = PLUTOFILTER_MIN(2 * x + 1, in.width - 1);
+
+                uint32_t sum_ag = 0, sum_rb = 0;
+                uint32_t pixel = plutofilter__downsample_tap(row0, x0, linear);
+                PLUTOFILTER_DOWNSAMPLE_ACCUMULATE(pixel, 1, sum_ag, sum_rb);
+                pixel = plutofilter__downsample_tap(row0, x1, linear);
+                PLUTOFILTER_DOWNSAMPLE_ACCUMULATE(pixel, 1, sum_ag, sum_rb);
+                pixel = plutofilter__downsample_tap(row1, x0, linear);
+                PLUTOFILTER_DOWNSAMPLE_ACCUMULATE(pixel, 1, sum_ag, sum_rb);
+                pixel = plutofilter__downsample_tap(row1, x1, linear);
+                PLUTOFILTER_DOWNSAMPLE_ACCUMULATE(pixel, 1, sum_ag, sum_rb);
+
+                pixel = PLUTOFILTER_DOWNSAMPLE_RESOLVE(sum_ag, sum_rb, 2);
+                out.pixels[y * out.stride + x] = linear ? plutofilter__linear_rgb_to_srgb_pixel(pixel) : pixel;
+            }
+        }
+    }
+}
+
+void plutofilter_downsample_chain(plutofilter_surface_t in, plutofilter_surface_t* levels, int count, plutofilter_downsample_filter_t filter, plutofilter_color_space_t color_space)
+{
+    for(int i = 0; i < count; i++) {
+        plutofilter_downsample_2x(in, levels[i], filter, color_space);
+        in = levels[i];
+    }
+}
+
+#define PLUTOFILTER_RESAMPLE_PRECISION 14
+#define PLUTOFILTER_RESAMPLE_MAX_TAPS 256
+#define PLUTOFILTER_RESIZE_TABLE_SIZE 8192
+#define PLUTOFILTER_RESIZE_SPAN 1024
+#define PLUTOFILTER_RESIZE_CHUNK 64
+#define PLUTOFILTER_RESIZE_INTERMEDIATE_SHIFT 7
+#define PLUTOFILTER_PI 3.14159265358979323846f
+
+static float plutofilter__resample_radius(plutofilter_resample_filter_t filter)
+{
+    switch(filter) {
+    case PLUTOFILTER_RESAMPLE_FILTER_BICUBIC:
+        return 2.f;
+    case PLUTOFILTER_RESAMPLE_FILTER_LANCZOS:
+        return 3.f;
+    default:
+        return 1.f;
+    }
+}
+
+static float plutofilter__resample_kernel(plutofilter_resample_filter_t filter, float x)
+{
+    x = fabsf(x);
+    switch(filter) {
+    case PLUTOFILTER_RESAMPLE_FILTER_BICUBIC:
+        if(x < 1.f)
+            return (1.5f * x - 2.5f) * x * x + 1.f;
+        if(x < 2.f)
+            return ((-0.5f * x + 2.5f) * x - 4.f) * x + 2.f;
+        return 0.f;
+    case PLUTOFILTER_RESAMPLE_FILTER_LANCZOS:
+        if(x < 1e-5f)
+            return 1.f;
+        if(x < 3.f)
+            return 3.f * sinf(PLUTOFILTER_PI * x) * sinf(PLUTOFILTER_PI * x / 3.f) / (PLUTOFILTER_PI * PLUTOFILTER_PI * x * x);
+        return 0.f;
+    default:
+        return PLUTOFILTER_MAX(1.f - x, 0.f);
+    }
+}
+
+typedef struct {
+    plutofilter_resample_filter_t filter;
+    float scale;
+    float filter_scale;
+    float support;
+    int taps;
+    int length;
+} plutofilter__resample_axis_t;
+
+static plutofilter__resample_axis_t plutofilter__resample_axis(plutofilter_resample_filter_t filter, int in_length, int out_length)
+{
+    plutofilter__resample_axis_t axis;
+    const float radius = plutofilter__resample_radius(filter);
+    axis.filter = filter;
+    axis.scale = (float)in_length / out_length;
+    axis.support = PLUTOFILTER_MIN(radius * PLUTOFILTER_MAX(axis.scale, 1.f), (PLUTOFILTER_RESAMPLE_MAX_TAPS - 2) / 2.f);
+    axis.filter_scale = PLUTOFILTER_MAX(axis.support / radius, 1.f);
+    // A window of width 2 * support spans at most ceil(2 * support) + 2 integer positions.
+    axis.taps = (int)ceilf(2.f * axis.support) + 2;
+    axis.length = in_length;
+    return axis;
+}
+
+// Computes the fixed-point weights of one output pixel, normalized to sum to exactly one, and returns their
+// count. Taps outside the input are dropped rather than clamped, so edges are not overweighted.
+static int plutofilter__resample_weights(const plutofilter__resample_axis_t* axis, int index, int16_t* weights, int* first)
+{
+    const float center = (index + 0.5f) * axis->scale - 0.5f;
+    const int lo = PLUTOFILTER_MAX((int)floorf(center - axis->support), 0);
+    const int hi = PLUTOFILTER_MIN((int)ceilf(center + axis->support), PLUTOFILTER_MIN(axis->length - 1, lo + axis->taps - 1));
+    const int count = hi - lo + 1;
+
+    float values[PLUTOFILTER_RESAMPLE_MAX_TAPS];
+    float sum = 0.f;
+    for(int i = 0; i < count; i++) {
+        values[i] = plutofilter__resample_kernel(axis->filter, (lo + i - center) / axis->filter_scale);
+        sum += values[i];
+    }
+
+    const int one = 1 << PLUTOFILTER_RESAMPLE_PRECISION;
+    int total = 0;
+    int largest = 0;
+    for(int i = 0; i < count; i++) {
+        weights[i] = (int16_t)floorf(values[i] / sum * one + 0.5f);
+        total += weights[i];
+        if(weights[i] > weights[largest]) {
+            largest = i;
+        }
+    }
+
+    weights[largest] += one - total;
+    *first = lo;
+    return count;
+}
+
+void plutofilter_resize(plutofilter_surface_t in, plutofilter_surface_t out, plutofilter_resample_filter_t filter)
+{
+    if(in.width == 0 || in.height == 0 || out.width == 0 || out.height == 0)
+        return;
+    const plutofilter__resample_axis_t axis_x = plutofilter__resample_axis(filter, in.width, out.width);
+    const plutofilter__resample_axis_t axis_y = plutofilter__resample_axis(filter, in.height, out.height);
+
+    // Output columns are processed in chunks whose horizontal weights and input span fit on the stack.
+    int chunk = PLUTOFILTER_MIN(PLUTOFILTER_RESIZE_CHUNK, PLUTOFILTER_RESIZE_TABLE_SIZE / axis_x.taps);
+    chunk = PLUTOFILTER_MIN(chunk, (int)((PLUTOFILTER_RESIZE_SPAN - axis_x.taps) / ceilf(axis_x.scale)) + 1);
+    chunk = PLUTOFILTER_MAX(chunk, 1);
+
+    int16_t weights_x[PLUTOFILTER_RESIZE_TABLE_SIZE];
+    int16_t weights_y[PLUTOFILTER_RESAMPLE_MAX_TAPS];
+    int firsts[PLUTOFILTER_RESIZE_CHUNK];
+    int counts[PLUTOFILTER_RESIZE_CHUNK];
+    int32_t columns[PLUTOFILTER_RESIZE_SPAN][4];
+
+    for(int x0 = 0; x0 < out.width; x0 += chunk) {
+        const int size = PLUTOFILTER_MIN(chunk, out.width - x0);
+        int span_lo = in.width;
+        int span_hi = 0;
+        for(int k = 0; k < size; k++) {
+            counts[k] = plutofilter__resample_weights(&axis_x, x0 + k, weights_x + k * axis_x.taps, &firsts[k]);
+            span_lo = PLUTOFILTER_MIN(span_lo, firsts[k]);
+            span_hi = PLUTOFILTER_MAX(span_hi, firsts[k] + counts[k]);
+        }
+
+        const int span = span_hi - span_lo;
+        for(int y = 0; y < out.height; y++) {
+            int first_y;
+            const int count_y = plutofilter__resample_weights(&axis_y, y, weights_y, &first_y);
+
+            memset(columns, 0, span * sizeof(columns[0]));
+            for(int j = 0; j < count_y; j++) {
+                const int32_t weight = weights_y[j];
+                const uint32_t* row = in.pixels + (first_y + j) * in.stride + span_lo;
+                for(int i = 0; i < span; i++) {
+                    const uint32_t pixel = row[i];
+                    columns[i][0] += weight * (int32_t)PLUTOFILTER_RED(pixel);
+                    columns[i][1] += weight * (int32_t)PLUTOFILTER_GREEN(pixel);
+                    columns[i][2] += weight * (int32_t)PLUTOFILTER_BLUE(pixel);
+                    columns[i][3] += weight * (int32_t)PLUTOFILTER_ALPHA(pixel);
+                }
+            }
+
+            const int32_t round = 1 << (PLUTOFILTER_RESAMPLE_PRECISION - PLUTOFILTER_RESIZE_INTERMEDIATE_SHIFT - 1);
+            for(int i = 0; i < span; i++) {
+                for(int c = 0; c < 4; c++) {
+                    columns[i][c] = (columns[i][c] + round) >> (PLUTOFILTER_RESAMPLE_PRECISION - PLUTOFILTER_RESIZE_INTERMEDIATE_SHIFT);
+                }
+            }
+
+            for(int k = 0; k < size; k++) {
+                const int16_t* weights = weights_x + k * axis_x.taps;
+                const int32_t(*taps)[4] = (const int32_t(*)[4])(columns + firsts[k] - span_lo);
+                int32_t sums[4] = {0, 0, 0, 0};
+                for(int i = 0; i < counts[k]; i++) {
+                    for(int c = 0; c < 4; c++) {
+                        sums[c] += weights[i] * taps[i][c];
+                    }
+                }
+
+                const int shift = PLUTOFILTER_RESAMPLE_PRECISION + PLUTOFILTER_RESIZE_INTERMEDIATE_SHIFT;
+                const int32_t bias = 1 << (shift - 1);
+                int32_t a = PLUTOFILTER_CLAMP((sums[3] + bias) >> shift, 0, 255);
+                int32_t r = PLUTOFILTER_CLAMP((sums[0] + bias) >> shift, 0, a);
+                int32_t g = PLUTOFILTER_CLAMP((sums[1] + bias) >> shift, 0, a);
+                int32_t b = PLUTOFILTER_CLAMP((sums[2] + bias) >> shift, 0, a);
+                PLUTOFILTER_STORE_PIXEL(out, x0 + k, y, r, g, b, a);
+            }
+        }
+    }
+}
+
+#define PLUTOFILTER_TRANSFORM_TILE_SIZE 32
+
+// Fills the 2 * radius weights of the taps around a sample whose position is `fraction` past a pixel center,
+// normalized to sum to one. Lanczos weights derive every tap's sines from one pair by the angle-sum identity.
+static inline void plutofilter__sample_weights(plutofilter_resample_filter_t filter, float fraction, float* weights)
+{
+    const float t = fraction;
+    switch(filter) {
+    case PLUTOFILTER_RESAMPLE_FILTER_BICUBIC:
+        weights[0] = ((-0.5f * t + 1.f) * t - 0.5f) * t;
+        weights[1] = (1.5f * t - 2.5f) * t * t + 1.f;
+        weights[2] = ((-1.5f * t + 2.f) * t + 0.5f) * t;
+        weights[3] = (0.5f * t - 0.5f) * t * t;
+        break;
+    case PLUTOFILTER_RESAMPLE_FILTER_LANCZOS: {
+        static const float sin_steps[6] = {0.8660254f, 0.8660254f, 0.f, -0.8660254f, -0.8660254f, 0.f};
+        static const float cos_steps[6] = {-0.5f, 0.5f, 1.f, 0.5f, -0.5f, -1.f};
+        const float sin_t = sinf(PLUTOFILTER_PI * t);
+        const float sin_t3 = sinf(PLUTOFILTER_PI * t / 3.f);
+        const float cos_t3 = cosf(PLUTOFILTER_PI * t / 3.f);
+        float sum = 0.f;
+        for(int i = 0; i < 6; i++) {
+            const float d = t + 2.f - i;
+            if(fabsf(d) < 1e-5f) {
+                weights[i] = 1.f;
+            } else {
+                const float sign = (i & 1) ? -1.f : 1.f;
+                weights[i] = 3.f * sign * sin_t * (sin_t3 * cos_steps[i] + cos_t3 * sin_steps[i]) / (PLUTOFILTER_PI * PLUTOFILTER_PI * d * d);
+            }
+
+            sum += weights[i];
+        }
+
+        for(int i = 0; i < 6; i++)
+            weights[i] /= sum;
+        break;
+    }
+
+    default:
+        weights[0] = 1.f - t;
+        weights[1] = t;
+        break;
+    }
+}
+
+static inline uint32_t plutofilter__sample_pixel(plutofilter_surface_t in, plutofilter_resample_filter_t filter, int radius, float u, float v)
+{
+    const float floor_u = floorf(u);
+    const float floor_v = floorf(v);
+    const int x0 = (int)floor_u - radius + 1;
+    const int y0 = (int)floor_v - radius + 1;
+    const int taps = 2 * radius;
+
+    float weights_x[6], weights_y[6];
+    plutofilter__sample_weights(filter, u - floor_u, weights_x);
+    plutofilter__sample_weights(filter, v - floor_v, weights_y);
+
+    const int i0 = PLUTOFILTER_MAX(-x0, 0);
+    const int j0 = PLUTOFILTER_MAX(-y0, 0);
+    const int i1 = PLUTOFILTER_MIN(in.width - x0, taps);
+    const int j1 = PLUTOFILTER_MIN(in.height - y0, taps);
+
+    float sum_r = 0.f, sum_g = 0.f, sum_b = 0.f, sum_a = 0.f;
+    for(int j = j0; j < j1; j++) {
+        const uint32_t* row = in.pixels + (y0 + j) * in.stride + x0;
+        float row_r = 0.f, row_g = 0.f, row_b = 0.f, row_a = 0.f;
+        for(int i = i0; i < i1; i++) {
+            const uint32_t pixel = row[i];
+            row_r += weights_x[i] * PLUTOFILTER_RED(pixel);
+            row_g += weights_x[i] * PLUTOFILTER_GREEN(pixel);
+            row_b += weights_x[i] * PLUTOFILTER_BLUE(pixel);
+            row_a += weights_x[i] * PLUTOFILTER_ALPHA(pixel);
+        }
+
+        sum_r += weights_y[j] * row_r;
+        sum_g += weights_y[j] * row_g;
+        sum_b += weights_y[j] * row_b;
+        sum_a += weights_y[j] * row_a;
+    }
+
+    const float a = PLUTOFILTER_CLAMP(sum_a, 0.f, 255.f);
+    const float r = PLUTOFILTER_CLAMP(sum_r, 0.f, a);
+    const float g = PLUTOFILTER_CLAMP(sum_g, 0.f, a);
+    const float b = PLUTOFILTER_CLAMP(sum_b, 0.f, a);
+    return PLUTOFILTER_PACK_PIXEL(r + 0.5f, g + 0.5f, b + 0.5f, a + 0.5f);
+}
+
+#define PLUTOFILTER_LERP_LANES(p0, p1, w) \
+    ((((p0) & 0x00FF00FFu) * (256 - (w)) + ((p1) & 0x00FF00FFu) * (w)) >> 8 & 0x00FF00FFu)
+
+// Bilinear sampling of a position whose four taps all lie inside the surface, with 8-bit weights applied to two
+// channels at a time in 16-bit lanes of a 32-bit word.
+static inline uint32_t plutofilter__sample_bilinear(plutofilter_surface_t in, float u, float v)
+{
+    const int x = (int)u;
+    const int y = (int)v;
+    const uint32_t wx = (uint32_t)((u - x) * 256.f + 0.5f);
+    const uint32_t wy = (uint32_t)((v - y) * 256.f + 0.5f);
+
+    const uint32_t* top = in.pixels + y * in.stride + x;
+    const uint32_t* bottom = top + in.stride;
+
+    const uint32_t top_rb = PLUTOFILTER_LERP_LANES(top[0], top[1], wx);
+    const uint32_t top_ag = PLUTOFILTER_LERP_LANES(top[0] >> 8, top[1] >> 8, wx);
+    const uint32_t bottom_rb = PLUTOFILTER_LERP_LANES(bottom[0], bottom[1], wx);
+    const uint32_t bottom_ag = PLUTOFILTER_LERP_LANES(bottom[0] >> 8, bottom[1] >> 8, wx);
+    return PLUTOFILTER_LERP_LANES(top_ag, bottom_ag, wy) << 8 | PLUTOFILTER_LERP_LANES(top_rb, bottom_rb, wy);
+}
+
+void plutofilter_transform(plutofilter_surface_t in, plutofilter_surface_t out, const float matrix[6], plutofilter_resample_filter_t filter)
+{
+    const float det = matrix[0] * matrix[3] - matrix[1] * matrix[2];
+    if(det == 0.f || in.width == 0 || in.height == 0) {
+        for(int y = 0; y < out.height; y++) {
+            memset(out.pixels + y * out.stride, 0, out.width * sizeof(uint32_t));
+        }
+
+        return;
+    }
+
+    // Inverse matrix, mapping output pixel centers to input pixel centers.
+    const float ia = matrix[3] / det;
+    const float ib = -matrix[1] / det;
+    const float ic = -matrix[2] / det;
+    const float id = matrix[0] / det;
+    const float ie = (matrix[2] * matrix[5] - matrix[3] * matrix[4]) / det + 0.5f * (ia + ic) - 0.5f;
+    const float jf = (matrix[1] * matrix[4] - matrix[0] * matrix[5]) / det + 0.5f * (ib + id) - 0.5f;
+
+    const int radius = (int)plutofilter__resample_radius(filter);
+    const float min_u = -(float)radius;
+    const float min_v = -(float)radius;
+    const float max_u = in.width - 1.f + radius;
+    const float max_v = in.height - 1.f + radius;
+
+    for(int ty = 0; ty < out.height; ty += PLUTOFILTER_TRANSFORM_TILE_SIZE) {
+        const int th = PLUTOFILTER_MIN(PLUTOFILTER_TRANSFORM_TILE_SIZE, out.height - ty);
+        for(int tx = 0; tx < out.width; tx += PLUTOFILTER_TRANSFORM_TILE_SIZE) {
+            const int tw = PLUTOFILTER_MIN(PLUTOFILTER_TRANSFORM_TILE_SIZE, out.width - tx);
+
+            // The tile maps to a parallelogram; its bounding box decides whether any sample can be covered.
+            float lo_u = INFINITY, lo_v = INFINITY, hi_u = -INFINITY, hi_v = -INFINITY;
+            for(int corner = 0; corner < 4; corner++) {
+                const float x = (float)(tx + (corner & 1) * (tw - 1));
+                const float y = (float)(ty + (corner >> 1) * (th - 1));
+                const float u = ia * x + ic * y + ie;
+                const float v = ib * x + id * y + jf;
+                lo_u = PLUTOFILTER_MIN(lo_u, u);
+                hi_u = PLUTOFILTER_MAX(hi_u, u);
+                lo_v = PLUTOFILTER_MIN(lo_v, v);
+                hi_v = PLUTOFILTER_MAX(hi_v, v);
+            }
+
+            if(hi_u <= min_u || lo_u >= max_u || hi_v <= min_v || lo_v >= max_v) {
+                for(int y = ty; y < ty + th; y++) {
+                    memset(out.pixels + y * out.stride + tx, 0, tw * sizeof(uint32_t));
+                }
+
+                continue;
+            }
+
+            for(int y = ty; y < ty + th; y++) {
+                float u = ia * tx + ic * y + ie;
+                float v = ib * tx + id * y + jf;
+                uint32_t* row = out.pixels + y * out.stride;
+                for(int x = tx; x < tx + tw; x++, u += ia, v += ib) {
+                    if(u <= min_u || u >= max_u || v <= min_v || v >= max_v) {
+                        row[x] = 0;
+                    } else if(filter == PLUTOFILTER_RESAMPLE_FILTER_BICUBIC) {
+                        row[x] = plutofilter__sample_pixel(in, PLUTOFILTER_RESAMPLE_FILTER_BICUBIC, 2, u, v);
+                    } else if(filter == PLUTOFILTER_RESAMPLE_FILTER_LANCZOS) {
+                        row[x] = plutofilter__sample_pixel(in, PLUTOFILTER_RESAMPLE_FILTER_LANCZOS, 3, u, v);
+                    } else if(u >= 0.f && v >= 0.f && u < in.width - 1.f && v < in.height - 1.f) {
+                        row[x] = plutofilter__sample_bilinear(in, u, v);
+                    } else {
+                        row[x] = plutofilter__sample_pixel(in, PLUTOFILTER_RESAMPLE_FILTER_BILINEAR, 1, u, v);
+                    }
+                }
+            }
+        }
+    }
+}
+
+#define PLUTOFILTER_TRANSPOSE_BLOCK_SIZE 16
+
+// Writes out(x, y) = base[x * step_x + y * step_y] for every output pixel, block by block. Each block reads
+// as many input cache lines as it writes output ones, instead of one input line per output pixel.
+static void plutofilter__transpose_blocked(plutofilter_surface_t out, const uint32_t* base, ptrdiff_t step_x, ptrdiff_t step_y)
+{
+    for(int by = 0; by < out.height; by += PLUTOFILTER_TRANSPOSE_BLOCK_SIZE) {
+        const int bh = PLUTOFILTER_MIN(PLUTOFILTER_TRANSPOSE_BLOCK_SIZE, out.height - by);
+        for(int bx = 0; bx < out.width; bx += PLUTOFILTER_TRANSPOSE_BLOCK_SIZE) {
+            const int bw = PLUTOFILTER_MIN(PLUTOFILTER_TRANSPOSE_BLOCK_SIZE, out.width - bx);
+            for(int y = by; y < by + bh; y++) {
+                const uint32_t* src = base + bx * step_x + y * step_y;
+                uint32_t* dst = out.pixels + y * out.stride + bx;
+                for(int x = 0; x < bw; x++) {
+                    dst[x] = src[x * step_x];
+                }
+            }
+        }
+    }
+}
+
+// Maps out(x, y) to in(flip_x ? width - 1 - y : y, flip_y ? height - 1 - x : x).
+static void plutofilter__transpose(plutofilter_surface_t in, plutofilter_surface_t out, int flip_x, int flip_y)
+{
+    out.width = PLUTOFILTER_MIN(out.width, in.height);
+    out.height = PLUTOFILTER_MIN(out.height, in.width);
+    if(out.width == 0 || out.height == 0)
+        return;
+    const uint32_t* base = in.pixels;
+    ptrdiff_t step_x = in.stride;
+    ptrdiff_t step_y = 1;
+    if(flip_x) {
+        base += in.width - 1;
+        step_y = -1;
+    }
 
-#define PLUTOFILTER_CLAMP(v, lo, hi) \
-    ((v) < (lo) ? (lo) : ((v) > (hi) ? (hi) : (v)))
+    if(flip_y) {
+        base += (ptrdiff_t)(in.height - 1) * in.stride;
+        step_x = -step_x;
+    }
 
-#define PLUTOFILTER_CLAMP_PIXEL(pixel) \
-    ((uint8_t)(PLUTOFILTER_CLAMP(pixel, 0, 255)))
+    plutofilter__transpose_blocked(out, base, step_x, step_y);
+}
 
-#define PLUTOFILTER_OVERLAP_SURFACE(a, b) \
-    do { \
-        uint16_t __width = (a).width; \
-        uint16_t __height = (a).height; \
-        if((b).width < __width) __width = (b).width; \
-        if((b).height < __height) __height = (b).height; \
-        (a).width = (b).width = __width; \
-        (a).height = (b).height = __height; \
-    } while(0)
+// Maps out(x, y) to in(flip_x ? width - 1 - x : x, flip_y ? height - 1 - y : y), swapping mirrored pairs
+// so the surfaces may be the same.
+static void plutofilter__mirror(plutofilter_surface_t in, plutofilter_surface_t out, int flip_x, int flip_y)
+{
+    PLUTOFILTER_OVERLAP_SURFACE(in, out);
 
-#define PLUTOFILTER_OVERLAP_SURFACE3(a, b, c) \
-    do { \
-        uint16_t __width = (a).width; \
-        uint16_t __height = (a).height; \
-        if((b).width < __width) __width = (b).width; \
-        if((c).width < __width) __width = (c).width; \
-        if((b).height < __height) __height = (b).height; \
-        if((c).height < __height) __height = (c).height; \
-        (a).width = (b).width = (c).width = __width; \
-        (a).height = (b).height = (c).height = __height; \
-    } while(0)
+    const int rows = flip_y ? (out.height + 1) / 2 : out.height;
+    for(int y = 0; y < rows; y++) {
+        const int y2 = flip_y ? out.height - 1 - y : y;
+        const int count = (y == y2 && flip_x) ? (out.width + 1) / 2 : out.width;
+        const uint32_t* src1 = in.pixels + y * in.stride;
+        const uint32_t* src2 = in.pixels + y2 * in.stride;
+        uint32_t* dst1 = out.pixels + y * out.stride;
+        uint32_t* dst2 = out.pixels + y2 * out.stride;
+        for(int x = 0; x < count; x++) {
+            const int x2 = flip_x ? out.width - 1 - x : x;
+            const uint32_t pixel1 = src1[x];
+            const uint32_t pixel2 = src2[x2];
+            dst1[x] = pixel2;
+            dst2[x2] = pixel1;
+        }
+    }
+}
+
+void plutofilter_rotate(plutofilter_surface_t in, plutofilter_surface_t out, plutofilter_rotation_t rotation)
+{
+    switch(rotation) {
+    case PLUTOFILTER_ROTATION_90:
+        plutofilter__transpose(in, out, 0, 1);
+        break;
+    case PLUTOFILTER_ROTATION_180:
+        plutofilter__mirror(in, out, 1, 1);
+        break;
+    case PLUTOFILTER_ROTATION_270:
+        plutofilter__transpose(in, out, 1, 0);
+        break;
+    }
+}
+
+void plutofilter_flip(plutofilter_surface_t in, plutofilter_surface_t out, plutofilter_flip_t flip)
+{
+    plutofilter__mirror(in, out, flip == PLUTOFILTER_FLIP_HORIZONTAL, flip == PLUTOFILTER_FLIP_VERTICAL);
+}
+
+void plutofilter_transpose(plutofilter_surface_t in, plutofilter_surface_t out)
+{
+    plutofilter__transpose(in, out, 0, 0);
+}
+
+void plutofilter_orient(plutofilter_surface_t in, plutofilter_surface_t out, int orientation)
+{
+    switch(orientation) {
+    case 2:
+        plutofilter__mirror(in, out, 1, 0);
+        break;
+    case 3:
+        plutofilter__mirror(in, out, 1, 1);
+        break;
+    case 4:
+        plutofilter__mirror(in, out, 0, 1);
+        break;
+    case 5:
+        plutofilter__transpose(in, out, 0, 0);
+        break;
+    case 6:
+        plutofilter__transpose(in, out, 0, 1);
+        break;
+    case 7:
+        plutofilter__transpose(in, out, 1, 1);
+        break;
+    case 8:
+        plutofilter__transpose(in, out, 1, 0);
+        break;
+    default:
+        PLUTOFILTER_OVERLAP_SURFACE(in, out);
+        plutofilter__copy_surface(in, out);
+        break;
+    }
+}
+
+#define PLUTOFILTER_TURBULENCE_BSIZE 0x100
+#define PLUTOFILTER_TURBULENCE_BMASK 0xff
+#define PLUTOFILTER_TURBULENCE_PERLIN_N 0x1000
+#define PLUTOFILTER_TURBULENCE_RAND_M 2147483647
+#define PLUTOFILTER_TURBULENCE_RAND_A 16807
+#define PLUTOFILTER_TURBULENCE_RAND_Q 127773
+#define PLUTOFILTER_TURBULENCE_RAND_R 2836
+
+typedef struct {
+    int lattice[PLUTOFILTER_TURBULENCE_BSIZE + PLUTOFILTER_TURBULENCE_BSIZE + 2];
+    // Gradients of the four channels are interleaved so one lattice lookup serves them all.
+    float gradient[PLUTOFILTER_TURBULENCE_BSIZE + PLUTOFILTER_TURBULENCE_BSIZE + 2][4][2];
+} plutofilter__turbulence_t;
+
+typedef struct {
+    int width;
+    int height;
+    int wrap_x;
+    int wrap_y;
+} plutofilter__stitch_info_t;
+
+static int32_t plutofilter__turbulence_random(int32_t seed)
+{
+    int32_t result = PLUTOFILTER_TURBULENCE_RAND_A * (seed % PLUTOFILTER_TURBULENCE_RAND_Q) - PLUTOFILTER_TURBULENCE_RAND_R * (seed / PLUTOFILTER_TURBULENCE_RAND_Q);
+    if(result <= 0)
+        result += PLUTOFILTER_TURBULENCE_RAND_M;
+    return result;
+}
+
+static void plutofilter__turbulence_init(plutofilter__turbulence_t* turbulence, int32_t seed)
+{
+    if(seed <= 0)
+        seed = -(seed % (PLUTOFILTER_TURBULENCE_RAND_M - 1)) + 1;
+    if(seed > PLUTOFILTER_TURBULENCE_RAND_M - 1)
+        seed = PLUTOFILTER_TURBULENCE_RAND_M - 1;
+    for(int k = 0; k < 4; k++) {
+        for(int i = 0; i < PLUTOFILTER_TURBULENCE_BSIZE; i++) {
+            turbulence->lattice[i] = i;
+            for(int j = 0; j < 2; j++) {
+                seed = plutofilter__turbulence_random(seed);
+                turbulence->gradient[i][k][j] = (float)((seed % (PLUTOFILTER_TURBULENCE_BSIZE + PLUTOFILTER_TURBULENCE_BSIZE)) - PLUTOFILTER_TURBULENCE_BSIZE) / PLUTOFILTER_TURBULENCE_BSIZE;
+            }
+
+            float* gradient = turbulence->gradient[i][k];
+            float length = sqrtf(gradient[0] * gradient[0] + gradient[1] * gradient[1]);
+            gradient[0] /= length;
+            gradient[1] /= length;
+        }
+    }
+
+    for(int i = PLUTOFILTER_TURBULENCE_BSIZE - 1; i > 0; i--) {
+        int k = turbulence->lattice[i];
+        seed = plutofilter__turbulence_random(seed);
+        int j = seed % PLUTOFILTER_TURBULENCE_BSIZE;
+        turbulence->lattice[i] = turbulence->lattice[j];
+        turbulence->lattice[j] = k;
+    }
+
+    for(int i = 0; i < PLUTOFILTER_TURBULENCE_BSIZE + 2; i++) {
+        turbulence->lattice[PLUTOFILTER_TURBULENCE_BSIZE + i] = turbulence->lattice[i];
+        memcpy(turbulence->gradient[PLUTOFILTER_TURBULENCE_BSIZE + i], turbulence->gradient[i], sizeof(turbulence->gradient[i]));
+    }
+}
+
+#define PLUTOFILTER_S_CURVE(t) ((t) * (t) * (3.f - 2.f * (t)))
+#define PLUTOFILTER_LERP(t, a, b) ((a) + (t) * ((b) - (a)))
+
+static void plutofilter__turbulence_noise2(const plutofilter__turbulence_t* turbulence, float vec_x, float vec_y, const plutofilter__stitch_info_t* stitch, float noise[4])
+{
+    float t = vec_x + PLUTOFILTER_TURBULENCE_PERLIN_N;
+    int bx0 = (int)t;
+    int bx1 = bx0 + 1;
+    const float rx0 = t - (int)t;
+    const float rx1 = rx0 - 1.f;
+
+    t = vec_y + PLUTOFILTER_TURBULENCE_PERLIN_N;
+    int by0 = (int)t;
+    int by1 = by0 + 1;
+    const float ry0 = t - (int)t;
+    const float ry1 = ry0 - 1.f;
+
+    // Lattice points are wrapped before they are masked; masking first, as the reference code does,
+    // would make the stitching comparisons always fail.
+    if(stitch) {
+        if(bx0 >= stitch->wrap_x)
+            bx0 -= stitch->width;
+        if(bx1 >= stitch->wrap_x)
+            bx1 -= stitch->width;
+        if(by0 >= stitch->wrap_y)
+            by0 -= stitch->height;
+        if(by1 >= stitch->wrap_y) {
+            by1 -= stitch->height;
+        }
+    }
+
+    bx0 &= PLUTOFILTER_TURBULENCE_BMASK;
+    bx1 &= PLUTOFILTER_TURBULENCE_BMASK;
+    by0 &= PLUTOFILTER_TURBULENCE_BMASK;
+    by1 &= PLUTOFILTER_TURBULENCE_BMASK;
+
+    const int i = turbulence->lattice[bx0];
+    const int j = turbulence->lattice[bx1];
+    const float (*q00)[2] = turbulence->gradient[turbulence->lattice[i + by0]];
+    const float (*q10)[2] = turbulence->gradient[turbulence->lattice[j + by0]];
+    const float (*q01)[2] = turbulence->gradient[turbulence->lattice[i + by1]];
+    const float (*q11)[2] = turbulence->gradient[turbulence->lattice[j + by1]];
+
+    const float sx = PLUTOFILTER_S_CURVE(rx0);
+    const float sy = PLUTOFILTER_S_CURVE(ry0);
+    for(int c = 0; c < 4; c++) {
+        const float a = PLUTOFILTER_LERP(sx, rx0 * q00[c][0] + ry0 * q00[c][1], rx1 * q10[c][0] + ry0 * q10[c][1]);
+        const float b = PLUTOFILTER_LERP(sx, rx0 * q01[c][0] + ry1 * q01[c][1], rx1 * q11[c][0] + ry1 * q11[c][1]);
+        noise[c] = PLUTOFILTER_LERP(sy, a, b);
+    }
+}
+
+static float plutofilter__stitch_frequency(float frequency, float size)
+{
+    if(frequency == 0.f)
+        return frequency;
+    const float lo = floorf(size * frequency) / size;
+    const float hi = ceilf(size * frequency) / size;
+    return (lo > 0.f && frequency / lo < hi / frequency) ? lo : hi;
+}
+
+void plutofilter_turbulence(plutofilter_surface_t out, float base_frequency_x, float base_frequency_y, int num_octaves, int seed, int stitch_tiles, plutofilter_turbulence_type_t type)
+{
+    plutofilter__turbulence_t turbulence;
+    plutofilter__turbulence_init(&turbulence, seed);
+
+    plutofilter__stitch_info_t stitch_base = {0, 0, 0, 0};
+    if(stitch_tiles) {
+        base_frequency_x = plutofilter__stitch_frequency(base_frequency_x, out.width);
+        base_frequency_y = plutofilter__stitch_frequency(base_frequency_y, out.height);
+        stitch_base.width = (int)(out.width * base_frequency_x + 0.5f);
+        stitch_base.wrap_x = PLUTOFILTER_TURBULENCE_PERLIN_N + stitch_base.width;
+        stitch_base.height = (int)(out.height * base_frequency_y + 0.5f);
+        stitch_base.wrap_y = PLUTOFILTER_TURBULENCE_PERLIN_N + stitch_base.height;
+    }
+
+    const int fractal_sum = type == PLUTOFILTER_TURBULENCE_TYPE_FRACTAL_NOISE;
+    for(int y = 0; y < out.height; y++) {
+        for(int x = 0; x < out.width; x++) {
+            plutofilter__stitch_info_t stitch = stitch_base;
+            float vec_x = x * base_frequency_x;
+            float vec_y = y * base_frequency_y;
+            float ratio = 1.f;
+            float sums[4] = {0.f, 0.f, 0.f, 0.f};
+            for(int octave = 0; octave < num_octaves; octave++) {
+                float noise[4];
+                plutofilter__turbulence_noise2(&turbulence, vec_x, vec_y, stitch_tiles ? &stitch : NULL, noise);
+                for(int c = 0; c < 4; c++) {
+                    sums[c] += (fractal_sum ? noise[c] : fabsf(noise[c])) / ratio;
+                }
+
+                vec_x *= 2.f;
+                vec_y *= 2.f;
+                ratio *= 2.f;
+                if(stitch_tiles) {
+                    stitch.width *= 2;
+                    stitch.wrap_x = 2 * stitch.wrap_x - PLUTOFILTER_TURBULENCE_PERLIN_N;
+                    stitch.height *= 2;
+                    stitch.wrap_y = 2 * stitch.wrap_y - PLUTOFILTER_TURBULENCE_PERLIN_N;
+                }
+            }
+
+            uint32_t channels[4];
+            for(int c = 0; c < 4; c++) {
+                const float value = fractal_sum ? (sums[c] * 255.f + 255.f) * 0.5f : sums[c] * 255.f;
+                channels[c] = (uint32_t)(PLUTOFILTER_CLAMP(value, 0.f, 255.f) + 0.5f);
+            }
+
+            uint32_t r = channels[0], g = channels[1], b = channels[2], a = channels[3];
+            PLUTOFILTER_PREMULTIPLY_PIXEL(r, g, b, a);
+            PLUTOFILTER_STORE_PIXEL(out, x, y, r, g, b, a);
+        }
+    }
+}
+
+static inline int plutofilter__channel_shift(plutofilter_channel_t channel)
+{
+    switch(channel) {
+    case PLUTOFILTER_CHANNEL_R:
+        return 16;
+    case PLUTOFILTER_CHANNEL_G:
+        return 8;
+    case PLUTOFILTER_CHANNEL_B:
+        return 0;
+    default:
+        return 24;
+    }
+}
+
+void plutofilter_displacement_map(plutofilter_surface_t in, plutofilter_surface_t map, plutofilter_surface_t out, float scale, plutofilter_channel_t x_channel, plutofilter_channel_t y_channel)
+{
+    PLUTOFILTER_OVERLAP_SURFACE3(in, map, out);
+
+    const int x_shift = plutofilter__channel_shift(x_channel);
+    const int y_shift = plutofilter__channel_shift(y_channel);
+    const float factor = scale / 255.f;
+    const float offset = -0.5f * scale;
+
+    const float max_u = in.width - 1.f;
+    const float max_v = in.height - 1.f;
+    for(int y = 0; y < out.height; y++) {
+        const uint32_t* map_row = map.pixels + y * map.stride;
+        uint32_t* row = out.pixels + y * out.stride;
+        for(int x = 0; x < out.width; x++) {
+            const uint32_t pixel = map_row[x];
+            uint32_t dx = (pixel >> x_shift) & 0xFF;
+            uint32_t dy = (pixel >> y_shift) & 0xFF;
+
+            // Color channels of the map are unpremultiplied before use.
+            const uint32_t a = PLUTOFILTER_ALPHA(pixel);
+            if(a != 255) {
+                if(x_shift != 24)
+                    dx = a ? 255 * dx / a : 0;
+                if(y_shift != 24) {
+                    dy = a ? 255 * dy / a : 0;
+                }
+            }
+
+            const float u = x + dx * factor + offset;
+            const float v = y + dy * factor + offset;
+            if(u >= 0.f && v >= 0.f && u < max_u && v < max_v) {
+                row[x] = plutofilter__sample_bilinear(in, u, v);
+            } else if(u <= -1.f || v <= -1.f || u >= in.width || v >= in.height) {
+                row[x] = 0;
+            } else {
+                row[x] = plutofilter__sample_pixel(in, PLUTOFILTER_RESAMPLE_FILTER_BILINEAR, 1, u, v);
+            }
+        }
+    }
+}
+
+// Computes the unnormalized surface normal (nx, ny, 1) at a pixel with the SVG lighting kernels. Edge and
+// corner pixels use the one-sided kernels of the specification, which all reduce to weighted differences
+// across the available neighbours.
+static void plutofilter__surface_normal(plutofilter_surface_t in, int x, int y, float surface_scale, float* nx, float* ny)
+{
+    const int left = x > 0 ? x - 1 : x;
+    const int right = x < in.width - 1 ? x + 1 : x;
+    const int top = y > 0 ? y - 1 : y;
+    const int bottom = y < in.height - 1 ? y + 1 : y;
+
+    int sum_x = 0, weight_x = 0;
+    int sum_y = 0, weight_y = 0;
+    for(int j = top; j <= bottom; j++) {
+        const int weight = j == y ? 2 : 1;
+        sum_x += weight * ((int)PLUTOFILTER_ALPHA(PLUTOFILTER_GET_PIXEL(in, right, j)) - (int)PLUTOFILTER_ALPHA(PLUTOFILTER_GET_PIXEL(in, left, j)));
+        weight_x += weight;
+    }
+
+    for(int i = left; i <= right; i++) {
+        const int weight = i == x ? 2 : 1;
+        sum_y += weight * ((int)PLUTOFILTER_ALPHA(PLUTOFILTER_GET_PIXEL(in, i, bottom)) - (int)PLUTOFILTER_ALPHA(PLUTOFILTER_GET_PIXEL(in, i, top)));
+        weight_y += weight;
+    }
+
+    const float scale = -surface_scale / 255.f;
+    *nx = right > left ? scale * 2.f * sum_x / (weight_x * (right - left)) : 0.f;
+    *ny = bottom > top ? scale * 2.f * sum_y / (weight_y * (bottom - top)) : 0.f;
+}
+
+#define PLUTOFILTER_POW_TABLE_SIZE 1024
+
+// The lighting filters work on chunks of a row at a time, first the normals, then the light vectors, then the
+// shading, each in its own loop over stack buffers.
+#define PLUTOFILTER_LIGHTING_CHUNK 256
+
+// Reciprocal square root from a bit-level estimate refined by three Newton steps, to within a few ulps. Unlike
+// sqrtf it never sets errno, so loops that use it still vectorize under the default math flags. An input of
+// zero gives a large finite result, so a zero vector scaled by it stays zero.
+static inline float plutofilter__rsqrt(float x)
+{
+    uint32_t bits;
+    memcpy(&bits, &x, sizeof(bits));
+    bits = 0x5F375A86u - (bits >> 1);
+
+    float y;
+    memcpy(&y, &bits, sizeof(y));
+    const float half = 0.5f * x;
+    y = y * (1.5f - half * y * y);
+    y = y * (1.5f - half * y * y);
+    y = y * (1.5f - half * y * y);
+    return y;
+}
+
+// Fills a table of pow(t, exponent) for t in [0, 1] when the exponent is in the SVG 1.1 range of 1 to 128, and
+// returns whether it did. The extra entry lets lookups interpolate at t = 1 without a bounds check.
+static int plutofilter__pow_table(float* table, float exponent)
+{
+    if(exponent < 1.f || exponent > 128.f)
+        return 0;
+    for(int i = 0; i <= PLUTOFILTER_POW_TABLE_SIZE; i++)
+        table[i] = powf((float)i / PLUTOFILTER_POW_TABLE_SIZE, exponent);
+    table[PLUTOFILTER_POW_TABLE_SIZE + 1] = 1.f;
+    return 1;
+}
+
+// Looks up a value in [-1, 1], clamping the index in integers; the results below 0 are for callers to discard.
+static inline float plutofilter__pow_lookup(const float* table, float value)
+{
+    const float t = value * PLUTOFILTER_POW_TABLE_SIZE;
+    const int index = (int)t;
+    const float fraction = t - index;
+    const int i = PLUTOFILTER_CLAMP(index, 0, PLUTOFILTER_POW_TABLE_SIZE);
+    return table[i] + fraction * (table[i + 1] - table[i]);
+}
+
+typedef struct {
+    const plutofilter_light_source_t* source;
+    float surface_scale;
+    float direction[3];
+    float spot_direction[3];
+    float cone_cosine;
+    float color[3];
+    int use_table;
+    float table[PLUTOFILTER_POW_TABLE_SIZE + 2];
+} plutofilter__light_t;
+
+static void plutofilter__light_init(plutofilter__light_t* light, const plutofilter_light_source_t* source, float surface_scale, uint32_t lighting_color)
+{
+    light->source = source;
+    light->surface_scale = surface_scale;
+    light->color[0] = (float)PLUTOFILTER_RED(lighting_color);
+    light->color[1] = (float)PLUTOFILTER_GREEN(lighting_color);
+    light->color[2] = (float)PLUTOFILTER_BLUE(lighting_color);
+    light->use_table = 0;
+    if(source->type == PLUTOFILTER_LIGHT_TYPE_DISTANT) {
+        const float azimuth = plutofilter__deg2rad(source->azimuth);
+        const float elevation = plutofilter__deg2rad(source->elevation);
+        light->direction[0] = cosf(azimuth) * cosf(elevation);
+        light->direction[1] = sinf(azimuth) * cosf(elevation);
+        light->direction[2] = sinf(elevation);
+    } else if(source->type == PLUTOFILTER_LIGHT_TYPE_SPOT) {
+        float sx = source->points_at_x - source->x;
+        float sy = source->points_at_y - source->y;
+        float sz = source->points_at_z - source->z;
+        float length = sqrtf(sx * sx + sy * sy + sz * sz);
+        if(length > 0.f) {
+            sx /= length;
+            sy /= length;
+            sz /= length;
+        }
+
+        light->spot_direction[0] = sx;
+        light->spot_direction[1] = sy;
+        light->spot_direction[2] = sz;
+        light->cone_cosine = fabsf(source->limiting_cone_angle) < 90.f ? cosf(plutofilter__deg2rad(source->limiting_cone_angle)) : 0.f;
+        light->use_table = plutofilter__pow_table(light->table, source->specular_exponent);
+    }
+}
+
+// Computes the unit surface normals of `count` pixels of row `y` from `x0`. Interior pixels take a branch-free
+// loop over the three rows around them; only the pixels on the border of the surface use the one-sided kernels.
+static void plutofilter__lighting_normals(plutofilter_surface_t in, int x0, int y, int count, float surface_scale, float* normal_x, float* normal_y, float* normal_z)
+{
+    int first = 0;
+    int last = 0;
+    if(y > 0 && y < in.height - 1) {
+        first = x0 == 0 ? 1 : 0;
+        last = PLUTOFILTER_MAX(PLUTOFILTER_MIN(count, in.width - 1 - x0), first);
+
+        const uint32_t* above = in.pixels + (y - 1) * in.stride + x0;
+        const uint32_t* row = above + in.stride;
+        const uint32_t* below = row + in.stride;
+        const float scale = -surface_scale / (4.f * 255.f);
+        for(int i = first; i < last; i++) {
+            const int sum_x = (int)(PLUTOFILTER_ALPHA(above[i + 1]) + 2 * PLUTOFILTER_ALPHA(row[i + 1]) + PLUTOFILTER_ALPHA(below[i + 1]))
+                              - (int)(PLUTOFILTER_ALPHA(above[i - 1]) + 2 * PLUTOFILTER_ALPHA(row[i - 1]) + PLUTOFILTER_ALPHA(below[i - 1]));
+            const int sum_y = (int)(PLUTOFILTER_ALPHA(below[i - 1]) + 2 * PLUTOFILTER_ALPHA(below[i]) + PLUTOFILTER_ALPHA(below[i + 1]))
+                              - (int)(PLUTOFILTER_ALPHA(above[i - 1]) + 2 * PLUTOFILTER_ALPHA(above[i]) + PLUTOFILTER_ALPHA(above[i + 1]));
+            normal_x[i] = scale * sum_x;
+            normal_y[i] = scale * sum_y;
+        }
+    }
+
+    for(int i = 0; i < first; i++)
+        plutofilter__surface_normal(in, x0 + i, y, surface_scale, &normal_x[i], &normal_y[i]);
+    for(int i = last; i < count; i++) {
+        plutofilter__surface_normal(in, x0 + i, y, surface_scale, &normal_x[i], &normal_y[i]);
+    }
+
+    for(int i = 0; i < count; i++) {
+        const float length = plutofilter__rsqrt(normal_x[i] * normal_x[i] + normal_y[i] * normal_y[i] + 1.f);
+        normal_x[i] *= length;
+        normal_y[i] *= length;
+        normal_z[i] = length;
+    }
+}
+
+// Computes the unit vectors from `count` pixels of row `y` toward the light, and the fraction of the light color
+// reaching each of them. The light type is chosen once, so each kind of light has a loop of its own.
+static void plutofilter__lighting_vectors(const plutofilter__light_t* light, plutofilter_surface_t in, int x0, int y, int count, float* light_x, float* light_y, float* light_z, float* falloff)
+{
+    const plutofilter_light_source_t* source = light->source;
+    if(source->type == PLUTOFILTER_LIGHT_TYPE_DISTANT) {
+        for(int i = 0; i < count; i++) {
+            light_x[i] = light->direction[0];
+            light_y[i] = light->direction[1];
+            light_z[i] = light->direction[2];
+            falloff[i] = 1.f;
+        }
+
+        return;
+    }
+
+    const uint32_t* row = in.pixels + y * in.stride + x0;
+    const float height = light->surface_scale / 255.f;
+    const float dx = source->x - x0;
+    const float dy = source->y - y;
+    for(int i = 0; i < count; i++) {
+        const float lx = dx - i;
+        const float lz = source->z - height * PLUTOFILTER_ALPHA(row[i]);
+        const float length = plutofilter__rsqrt(lx * lx + dy * dy + lz * lz);
+        light_x[i] = lx * length;
+        light_y[i] = dy * length;
+        light_z[i] = lz * length;
+    }
+
+    if(source->type == PLUTOFILTER_LIGHT_TYPE_POINT) {
+        for(int i = 0; i < count; i++)
+            falloff[i] = 1.f;
+        return;
+    }
+
+    const float sx = light->spot_direction[0];
+    const float sy = light->spot_direction[1];
+    const float sz = light->spot_direction[2];
+    const float cone = light->cone_cosine;
+    if(light->use_table) {
+        // The factors go to a local buffer first, which cannot alias the table, so the lookups can be gathered.
+        float factors[PLUTOFILTER_LIGHTING_CHUNK];
+        for(int i = 0; i < count; i++) {
+            const float cosine = -(light_x[i] * sx + light_y[i] * sy + light_z[i] * sz);
+            // Multiplying by the condition rather than selecting on it keeps the lookup out of a branch.
+            const float inside = (float)((cosine > 0.f) & (cosine >= cone));
+            factors[i] = plutofilter__pow_lookup(light->table, cosine) * inside;
+        }
+
+        memcpy(falloff, factors, count * sizeof(float));
+    } else {
+        for(int i = 0; i < count; i++) {
+            const float cosine = -(light_x[i] * sx + light_y[i] * sy + light_z[i] * sz);
+            falloff[i] = (cosine > 0.f && cosine >= cone) ? powf(cosine, source->specular_exponent) : 0.f;
+        }
+    }
+}
+
+void plutofilter_diffuse_lighting(plutofilter_surface_t in, plutofilter_surface_t out, float surface_scale, float diffuse_constant,
+                                  uint32_t lighting_color, const plutofilter_light_source_t* light_source)
+{
+    PLUTOFILTER_OVERLAP_SURFACE(in, out);
+
+    plutofilter__light_t light;
+    plutofilter__light_init(&light, light_source, surface_scale, lighting_color);
+
+    float normal_x[PLUTOFILTER_LIGHTING_CHUNK], normal_y[PLUTOFILTER_LIGHTING_CHUNK], normal_z[PLUTOFILTER_LIGHTING_CHUNK];
+    float light_x[PLUTOFILTER_LIGHTING_CHUNK], light_y[PLUTOFILTER_LIGHTING_CHUNK], light_z[PLUTOFILTER_LIGHTING_CHUNK];
+    float falloff[PLUTOFILTER_LIGHTING_CHUNK];
+    for(int y = 0; y < out.height; y++) {
+        for(int x0 = 0; x0 < out.width; x0 += PLUTOFILTER_LIGHTING_CHUNK) {
+            const int count = PLUTOFILTER_MIN(PLUTOFILTER_LIGHTING_CHUNK, out.width - x0);
+            plutofilter__lighting_normals(in, x0, y, count, surface_scale, normal_x, normal_y, normal_z);
+            plutofilter__lighting_vectors(&light, in, x0, y, count, light_x, light_y, light_z, falloff);
+
+            uint32_t* row = out.pixels + y * out.stride + x0;
+            for(int i = 0; i < count; i++) {
+                // Arithmetic comes before the clamps, which keeps the loop free of branches.
+                const float factor = diffuse_constant * (normal_x[i] * light_x[i] + normal_y[i] * light_y[i] + normal_z[i] * light_z[i]) * falloff[i];
+                const float red = factor * light.color[0] + 0.5f;
+                const float green = factor * light.color[1] + 0.5f;
+                const float blue = factor * light.color[2] + 0.5f;
+                const uint32_t r = (uint32_t)(int)PLUTOFILTER_CLAMP(red, 0.f, 255.5f);
+                const uint32_t g = (uint32_t)(int)PLUTOFILTER_CLAMP(green, 0.f, 255.5f);
+                const uint32_t b = (uint32_t)(int)PLUTOFILTER_CLAMP(blue, 0.f, 255.5f);
+                row[i] = PLUTOFILTER_PACK_PIXEL(r, g, b, 255);
+            }
+        }
+    }
+}
+
+// Stores specular pixels, whose alpha is their largest color channel.
+static inline void plutofilter__specular_store(uint32_t* row, int count, const float* factors, const float* color)
+{
+    for(int i = 0; i < count; i++) {
+        const float red = factors[i] * color[0] + 0.5f;
+        const float green = factors[i] * color[1] + 0.5f;
+        const float blue = factors[i] * color[2] + 0.5f;
+        uint32_t r = (uint32_t)(int)PLUTOFILTER_CLAMP(red, 0.f, 255.5f);
+        uint32_t g = (uint32_t)(int)PLUTOFILTER_CLAMP(green, 0.f, 255.5f);
+        uint32_t b = (uint32_t)(int)PLUTOFILTER_CLAMP(blue, 0.f, 255.5f);
+        uint32_t a = PLUTOFILTER_MAX(r, PLUTOFILTER_MAX(g, b));
+        PLUTOFILTER_PREMULTIPLY_PIXEL(r, g, b, a);
+        row[i] = PLUTOFILTER_PACK_PIXEL(r, g, b, a);
+    }
+}
+
+void plutofilter_specular_lighting(plutofilter_surface_t in, plutofilter_surface_t out, float surface_scale, float specular_constant,
+                                   float specular_exponent, uint32_t lighting_color, const plutofilter_light_source_t* light_source)
+{
+    PLUTOFILTER_OVERLAP_SURFACE(in, out);
+
+    plutofilter__light_t light;
+    plutofilter__light_init(&light, light_source, surface_scale, lighting_color);
+
+    // Exponents of the SVG 1.1 range are looked up instead of calling powf for every pixel.
+    float table[PLUTOFILTER_POW_TABLE_SIZE + 2];
+    const int use_table = plutofilter__pow_table(table, specular_exponent);
+
+    float normal_x[PLUTOFILTER_LIGHTING_CHUNK], normal_y[PLUTOFILTER_LIGHTING_CHUNK], normal_z[PLUTOFILTER_LIGHTING_CHUNK];
+    float light_x[PLUTOFILTER_LIGHTING_CHUNK], light_y[PLUTOFILTER_LIGHTING_CHUNK], light_z[PLUTOFILTER_LIGHTING_CHUNK];
+    float falloff[PLUTOFILTER_LIGHTING_CHUNK];
+    for(int y = 0; y < out.height; y++) {
+        for(int x0 = 0; x0 < out.width; x0 += PLUTOFILTER_LIGHTING_CHUNK) {
+            const int count = PLUTOFILTER_MIN(PLUTOFILTER_LIGHTING_CHUNK, out.width - x0);
+            plutofilter__lighting_normals(in, x0, y, count, surface_scale, normal_x, normal_y, normal_z);
+            plutofilter__lighting_vectors(&light, in, x0, y, count, light_x, light_y, light_z, falloff);
+
+            // The cosine between the normal and the halfway vector replaces the light vector in place.
+            for(int i = 0; i < count; i++) {
+                const float hz = light_z[i] + 1.f;
+                const float length = plutofilter__rsqrt(light_x[i] * light_x[i] + light_y[i] * light_y[i] + hz * hz);
+                light_x[i] = (normal_x[i] * light_x[i] + normal_y[i] * light_y[i] + normal_z[i] * hz) * length;
+            }
+
+            if(use_table) {
+                for(int i = 0; i < count; i++) {
+                    const float facing = (float)(light_x[i] > 0.f);
+                    falloff[i] *= specular_constant * plutofilter__pow_lookup(table, light_x[i]) * facing;
+                }
+            } else {
+                for(int i = 0; i < count; i++) {
+                    falloff[i] *= specular_constant * (light_x[i] > 0.f ? powf(light_x[i], specular_exponent) : 0.f);
+                }
+            }
+
+            plutofilter__specular_store(out.pixels + y * out.stride + x0, count, falloff, light.color);
+        }
+    }
+}
+
+plutofilter_surface_view_t plutofilter_offset_view(plutofilter_surface_t in, int dx, int dy)
+{
+    dx = PLUTOFILTER_CLAMP(dx, -(int)in.width, (int)in.width);
+    dy = PLUTOFILTER_CLAMP(dy, -(int)in.height, (int)in.height);
+
+    const int width = in.width - (dx < 0 ? -dx : dx);
+    const int height = in.height - (dy < 0 ? -dy : dy);
+
+    plutofilter_surface_view_t view;
+    view.surface = plutofilter_surface_make_sub(in, dx < 0 ? -dx : 0, dy < 0 ? -dy : 0, width, height);
+    view.left = dx > 0 ? dx : 0;
+    view.top = dy > 0 ? dy : 0;
+    view.right = in.width - width - view.left;
+    view.bottom = in.height - height - view.top;
+    return view;
+}
+
+void plutofilter_offset(plutofilter_surface_t in, plutofilter_surface_t out, int dx, int dy)
+{
+    PLUTOFILTER_OVERLAP_SURFACE(in, out);
+
+    const plutofilter_surface_view_t view = plutofilter_offset_view(in, dx, dy);
+    const int width = view.surface.width;
+    const int height = view.surface.height;
+
+    // Rows move toward the offset, so walk them from the far end to keep in-place sources intact.
+    for(int i = 0; i < height; i++) {
+        const int y = view.top > 0 ? height - 1 - i : i;
+        uint32_t* row = out.pixels + (y + view.top) * out.stride;
+        memmove(row + view.left, view.surface.pixels + y * view.surface.stride, width * sizeof(uint32_t));
+        memset(row, 0, view.left * sizeof(uint32_t));
+        memset(row + view.left + width, 0, view.right * sizeof(uint32_t));
+    }
+
+    for(int y = 0; y < view.top; y++) {
+        memset(out.pixels + y * out.stride, 0, out.width * sizeof(uint32_t));
+    }
+
+    for(int y = view.top + height; y < out.height; y++) {
+        memset(out.pixels + y * out.stride, 0, out.width * sizeof(uint32_t));
+    }
+}
+
+void plutofilter_tile(plutofilter_surface_t in, plutofilter_surface_t out, int x, int y)
+{
+    if(in.width == 0 || in.height == 0) {
+        plutofilter_flood(out, 0);
+        return;
+    }
+
+    const int start_x = ((-x % in.width) + in.width) % in.width;
+    const int start_y = ((-y % in.height) + in.height) % in.height;
+    const int rows = PLUTOFILTER_MIN(out.height, in.height);
+    for(int oy = 0; oy < rows; oy++) {
+        const uint32_t* src = in.pixels + ((start_y + oy) % in.height) * in.stride;
+        uint32_t* dst = out.pixels + oy * out.stride;
+
+        // Lay down one period of the tile, then double the written span until the row is full.
+        const int head = PLUTOFILTER_MIN(in.width - start_x, out.width);
+        const int tail = PLUTOFILTER_MIN(start_x, out.width - head);
+        memcpy(dst, src + start_x, head * sizeof(uint32_t));
+        memcpy(dst + head, src, tail * sizeof(uint32_t));
+        for(int filled = head + tail; filled < out.width; filled *= 2) {
+            memcpy(dst + filled, dst, PLUTOFILTER_MIN(filled, out.width - filled) * sizeof(uint32_t));
+        }
+    }
+
+    for(int oy = rows; oy < out.height; oy++) {
+        memcpy(out.pixels + oy * out.stride, out.pixels + (oy - in.height) * out.stride, out.width * sizeof(uint32_t));
+    }
+}
+
+void plutofilter_flood(plutofilter_surface_t out, uint32_t color)
+{
+    uint32_t r = PLUTOFILTER_RED(color);
+    uint32_t g = PLUTOFILTER_GREEN(color);
+    uint32_t b = PLUTOFILTER_BLUE(color);
+    uint32_t a = PLUTOFILTER_ALPHA(color);
+    PLUTOFILTER_PREMULTIPLY_PIXEL(r, g, b, a);
+
+    const uint32_t pixel = PLUTOFILTER_PACK_PIXEL(r, g, b, a);
+    for(int y = 0; y < out.height; y++) {
+        uint32_t* row = out.pixels + y * out.stride;
+        for(int x = 0; x < out.width; x++) {
+            row[x] = pixel;
+        }
+    }
+}
+
+static inline uint32_t plutofilter__luminance(uint32_t pixel)
+{
+    return (54 * PLUTOFILTER_RED(pixel) + 183 * PLUTOFILTER_GREEN(pixel) + 19 * PLUTOFILTER_BLUE(pixel)) >> 8;
+}
+
+// Keeps the part of a premultiplied pixel whose luminance exceeds the threshold, scaling every channel by
+// (luminance - threshold) / luminance so that hue is preserved.
+static inline uint32_t plutofilter__bloom_threshold(uint32_t pixel, uint32_t threshold, const uint32_t* reciprocals)
+{
+    const uint32_t luminance = plutofilter__luminance(pixel);
+    if(luminance <= threshold)
+        return 0;
+    const uint32_t factor = ((luminance - threshold) * reciprocals[luminance]) >> 8;
+    return ((((pixel >> 8) & PLUTOFILTER_DOWNSAMPLE_LANES) * factor) & ~PLUTOFILTER_DOWNSAMPLE_LANES)
+        | ((((pixel & PLUTOFILTER_DOWNSAMPLE_LANES) * factor) >> 8) & PLUTOFILTER_DOWNSAMPLE_LANES);
+}
+
+// Samples a surface upsampled 2x bilinearly at pixel (x, y), which weights the nearest four source pixels
+// by 9, 3, 3 and 1 sixteenths.
+static inline uint32_t plutofilter__bloom_upsample(plutofilter_surface_t in, int x, int y)
+{
+    const int x0 = x / 2;
+    const int y0 = y / 2;
+    const int x1 = (x & 1) ? PLUTOFILTER_MIN(x0 + 1, in.width - 1) : PLUTOFILTER_MAX(x0 - 1, 0);
+    const int y1 = (y & 1) ? PLUTOFILTER_MIN(y0 + 1, in.height - 1) : PLUTOFILTER_MAX(y0 - 1, 0);
+    const uint32_t* row0 = in.pixels + y0 * in.stride;
+    const uint32_t* row1 = in.pixels + y1 * in.stride;
+
+    uint32_t sum_ag = 0, sum_rb = 0;
+    PLUTOFILTER_DOWNSAMPLE_ACCUMULATE(row0[x0], 9, sum_ag, sum_rb);
+    PLUTOFILTER_DOWNSAMPLE_ACCUMULATE(row0[x1], 3, sum_ag, sum_rb);
+    PLUTOFILTER_DOWNSAMPLE_ACCUMULATE(row1[x0], 3, sum_ag, sum_rb);
+    PLUTOFILTER_DOWNSAMPLE_ACCUMULATE(row1[x1], 1, sum_ag, sum_rb);
+    return PLUTOFILTER_DOWNSAMPLE_RESOLVE(sum_ag, sum_rb, 4);
+}
 
-void plutofilter_color_transform(plutofilter_surface_t in, plutofilter_surface_t out, const float matrix[20])
+void plutofilter_bloom(plutofilter_surface_t in, plutofilter_surface_t out, float threshold, float intensity, int levels, uint32_t* scratch)
 {
     PLUTOFILTER_OVERLAP_SURFACE(in, out);
 
-    for(int y = 0; y < out.height; y++) {
-        for(int x = 0; x < out.width; x++) {
-            PLUTOFILTER_INIT_LOAD_PIXEL(in, x, y, r, g, b, a);
-            PLUTOFILTER_UNPREMULTIPLY_PIXEL(r, g, b, a);
+    plutofilter_surface_t pyramid[PLUTOFILTER_BLOOM_MAX_LEVELS];
+    int count = 0;
+    int width = out.width;
+    int height = out.height;
+    uint32_t* pixels = scratch;
+    while(count < PLUTOFILTER_BLOOM_MAX_LEVELS && count < levels && (width > 1 || height > 1)) {
+        width = (width + 1) / 2;
+        height = (height + 1) / 2;
+        pyramid[count++] = plutofilter_surface_make(pixels, width, height, width);
+        pixels += width * height;
+    }
 
-            float rr = r * matrix[ 0] + g * matrix[ 1] + b * matrix[ 2] + a * matrix[ 3] + matrix[ 4] * 255;
-            float gg = r * matrix[ 5] + g * matrix[ 6] + b * matrix[ 7] + a * matrix[ 8] + matrix[ 9] * 255;
-            float bb = r * matrix[10] + g * matrix[11] + b * matrix[12] + a * matrix[13] + matrix[14] * 255;
-            float aa = r * matrix[15] + g * matrix[16] + b * matrix[17] + a * matrix[18] + matrix[19] * 255;
+    if(count == 0 || intensity <= 0.f) {
+        plutofilter__copy_surface(in, out);
+        return;
+    }
 
-            r = PLUTOFILTER_CLAMP_PIXEL(rr);
-            g = PLUTOFILTER_CLAMP_PIXEL(gg);
-            b = PLUTOFILTER_CLAMP_PIXEL(bb);
-            a = PLUTOFILTER_CLAMP_PIXEL(aa);
+    uint32_t reciprocals[256];
+    reciprocals[0] = 0;
+    for(int i = 1; i < 256; i++)
+        reciprocals[i] = 65536 / i;
+    const uint32_t fixed_threshold = (uint32_t)(PLUTOFILTER_CLAMP(threshold, 0.f, 1.f) * 255.f + 0.5f);
+
+    // Threshold while reducing the input to the first level, so the full-size surface is read only once here.
+    const plutofilter_surface_t base = pyramid[0];
+    for(int y = 0; y < base.height; y++) {
+        const uint32_t* row0 = in.pixels + (2 * y) * in.stride;
+        const uint32_t* row1 = in.pixels + PLUTOFILTER_MIN(2 * y + 1, in.height - 1) * in.stride;
+        for(int x = 0; x < base.width; x++) {
+            const int x0 = 2 * x;
+            const int x1 = PLUTOFILTER_MIN(2 * x + 1, in.width - 1);
+
+            uint32_t sum_ag = 0, sum_rb = 0;
+            PLUTOFILTER_DOWNSAMPLE_ACCUMULATE(plutofilter__bloom_threshold(row0[x0], fixed_threshold, reciprocals), 1, sum_ag, sum_rb);
+            PLUTOFILTER_DOWNSAMPLE_ACCUMULATE(plutofilter__bloom_threshold(row0[x1], fixed_threshold, reciprocals), 1, sum_ag, sum_rb);
+            PLUTOFILTER_DOWNSAMPLE_ACCUMULATE(plutofilter__bloom_threshold(row1[x0], fixed_threshold, reciprocals), 1, sum_ag, sum_rb);
+            PLUTOFILTER_DOWNSAMPLE_ACCUMULATE(plutofilter__bloom_threshold(row1[x1], fixed_threshold, reciprocals), 1, sum_ag, sum_rb);
+            base.pixels[y * base.stride + x] = PLUTOFILTER_DOWNSAMPLE_RESOLVE(sum_ag, sum_rb, 2);
+        }
+    }
 
-            PLUTOFILTER_PREMULTIPLY_PIXEL(r, g, b, a);
+    for(int i = 1; i < count; i++) {
+        plutofilter_downsample_2x(pyramid[i - 1], pyramid[i], PLUTOFILTER_DOWNSAMPLE_FILTER_TENT, PLUTOFILTER_COLOR_SPACE_SRGB);
+    }
+
+    // Fold each level into the next larger one, averaging it with the upsampled glow accumulated so far.
+    for(int i = count - 1; i > 0; i--) {
+        const plutofilter_surface_t level = pyramid[i - 1];
+        for(int y = 0; y < level.height; y++) {
+            uint32_t* row = level.pixels + y * level.stride;
+            for(int x = 0; x < level.width; x++) {
+                const uint32_t a = row[x];
+                const uint32_t b = plutofilter__bloom_upsample(pyramid[i], x, y);
+                row[x] = ((a >> 1) & 0x7F7F7F7Fu) + ((b >> 1) & 0x7F7F7F7Fu) + (a & b & 0x01010101u);
+            }
+        }
+    }
+
+    const uint32_t scale = (uint32_t)(PLUTOFILTER_MIN(intensity, 256.f) * 256.f + 0.5f);
+    for(int y = 0; y < out.height; y++) {
+        for(int x = 0; x < out.width; x++) {
+            const uint32_t glow = plutofilter__bloom_upsample(base, x, y);
+            uint32_t ga = PLUTOFILTER_MIN((PLUTOFILTER_ALPHA(glow) * scale) >> 8, 255);
+            uint32_t gr = PLUTOFILTER_MIN((PLUTOFILTER_RED(glow) * scale) >> 8, ga);
+            uint32_t gg = PLUTOFILTER_MIN((PLUTOFILTER_GREEN(glow) * scale) >> 8, ga);
+            uint32_t gb = PLUTOFILTER_MIN((PLUTOFILTER_BLUE(glow) * scale) >> 8, ga);
+
+            PLUTOFILTER_INIT_LOAD_PIXEL(in, x, y, r, g, b, a);
+            r = r + gr - (r * gr + 127) / 255;
+            g = g + gg - (g * gg + 127) / 255;
+            b = b + gb - (b * gb + 127) / 255;
+            a = a + ga - (a * ga + 127) / 255;
             PLUTOFILTER_STORE_PIXEL(out, x, y, r, g, b, a);
         }
     }
 }
 
-void plutofilter_color_transform_opacity(plutofilter_surface_t in, plutofilter_surface_t out, float amount)
-{
-    const float matrix[] = {
-        1.0f, 0.0f, 0.0f, 0.0f, 0.0f,
-        0.0f, 1.0f, 0.0f, 0.0f, 0.0f,
-        0.0f, 0.0f, 1.0f, 0.0f, 0.0f,
-        0.0f, 0.0f, 0.0f, amount, 0.0f
-    };
+// Column histograms cover a vertical strip of the surface at a time, which bounds their stack size to about
+// 100 KB. Each strip yields PLUTOFILTER_MEDIAN_COLUMNS - 2 * radius output columns, which stays at least twice
+// the window width, so rebuilding the kernel histogram at the start of each strip row remains a small share
+// of the work even at the largest radius.
+#define PLUTOFILTER_MEDIAN_COLUMNS (4 * PLUTOFILTER_MEDIAN_MAX_RADIUS + 128)
 
-    plutofilter_color_transform(in, out, matrix);
-}
+typedef struct {
+    uint8_t fine[256];
+    uint8_t coarse[16];
+} plutofilter__column_histogram_t;
 
-void plutofilter_color_transform_brightness(plutofilter_surface_t in, plutofilter_surface_t out, float amount)
-{
-    const float matrix[] = {
-        amount, 0.0f,   0.0f,   0.0f, 0.0f,
-        0.0f,   amount, 0.0f,   0.0f, 0.0f,
-        0.0f,   0.0f,   amount, 0.0f, 0.0f,
-        0.0f,   0.0f,   0.0f,   1.0f, 0.0f
-    };
+typedef struct {
+    uint16_t fine[256];
+    uint16_t coarse[16];
+} plutofilter__kernel_histogram_t;
 
-    plutofilter_color_transform(in, out, matrix);
+static inline void plutofilter__column_histogram_update(plutofilter__column_histogram_t* columns, const uint32_t* row, int count, int shift, int delta)
+{
+    for(int i = 0; i < count; i++) {
+        const uint32_t value = (row[i] >> shift) & 0xFF;
+        columns[i].fine[value] += delta;
+        columns[i].coarse[value >> 4] += delta;
+    }
 }
 
-void plutofilter_color_transform_invert(plutofilter_surface_t in, plutofilter_surface_t out, float amount)
+// Moves the kernel histogram one column along, in a single pass over the bins that the compiler vectorizes.
+static inline void plutofilter__kernel_histogram_slide(plutofilter__kernel_histogram_t* kernel, const plutofilter__column_histogram_t* add, const plutofilter__column_histogram_t* remove)
 {
-    const float scale = 1.0f - 2.0f * amount;
-    const float matrix[] = {
-        scale, 0.0f,  0.0f,  0.0f, amount,
-        0.0f,  scale, 0.0f,  0.0f, amount,
-        0.0f,  0.0f,  scale, 0.0f, amount,
-        0.0f,  0.0f,  0.0f,  1.0f, 0.0f
-    };
-
-    plutofilter_color_transform(in, out, matrix);
+    for(int i = 0; i < 256; i++)
+        kernel->fine[i] += add->fine[i] - remove->fine[i];
+    for(int i = 0; i < 16; i++) {
+        kernel->coarse[i] += add->coarse[i] - remove->coarse[i];
+    }
 }
 
-void plutofilter_color_transform_contrast(plutofilter_surface_t in, plutofilter_surface_t out, float amount)
+static inline void plutofilter__kernel_histogram_add(plutofilter__kernel_histogram_t* kernel, const plutofilter__column_histogram_t* column)
 {
-    const float offset = (1.0f - amount) * 0.5f;
-    const float matrix[] = {
-        amount, 0.0f,   0.0f,   0.0f, offset,
-        0.0f,   amount, 0.0f,   0.0f, offset,
-        0.0f,   0.0f,   amount, 0.0f, offset,
-        0.0f,   0.0f,   0.0f,   1.0f, 0.0f
-    };
-
-    plutofilter_color_transform(in, out, matrix);
+    for(int i = 0; i < 256; i++)
+        kernel->fine[i] += column->fine[i];
+    for(int i = 0; i < 16; i++) {
+        kernel->coarse[i] += column->coarse[i];
+    }
 }
 
-void plutofilter_color_transform_saturate(plutofilter_surface_t in, plutofilter_surface_t out, float amount)
+// Finds the value of the given rank by locating its coarse bucket first, then its fine bin within the bucket.
+static inline uint32_t plutofilter__kernel_histogram_select(const plutofilter__kernel_histogram_t* kernel, int rank)
 {
-    const float matrix[] = {
-        0.213f + 0.787f * amount,
-        0.715f - 0.715f * amount,
-        0.072f - 0.072f * amount,
-        0.0f,
-        0.0f,
-
-        0.213f - 0.213f * amount,
-        0.715f + 0.285f * amount,
-        0.072f - 0.072f * amount,
-        0.0f,
-        0.0f,
-
-        0.213f - 0.213f * amount,
-        0.715f - 0.715f * amount,
-        0.072f + 0.928f * amount,
-        0.0f,
-        0.0f,
-
-        0.0f,
-        0.0f,
-        0.0f,
-        1.0f,
-        0.0f
-    };
-
-    plutofilter_color_transform(in, out, matrix);
+    int bucket = 0;
+    while(rank >= kernel->coarse[bucket])
+        rank -= kernel->coarse[bucket++];
+    int bin = bucket << 4;
+    while(rank >= kernel->fine[bin])
+        rank -= kernel->fine[bin++];
+    return bin;
 }
 
-void plutofilter_color_transform_grayscale(plutofilter_surface_t in, plutofilter_surface_t out, float amount)
+static void plutofilter__median_channel(plutofilter_surface_t in, plutofilter_surface_t out, int radius, int shift)
 {
-    const float inv_amount = 1.0f - amount;
-    const float matrix[] = {
-        inv_amount + amount * 0.2126f,
-        amount * 0.7152f,
-        amount * 0.0722f,
-        0.0f,
-        0.0f,
+    plutofilter__column_histogram_t columns[PLUTOFILTER_MEDIAN_COLUMNS];
+    plutofilter__kernel_histogram_t kernel;
+
+    const int span = PLUTOFILTER_MEDIAN_COLUMNS - 2 * radius;
+    for(int x0 = 0; x0 < out.width; x0 += span) {
+        const int x1 = PLUTOFILTER_MIN(x0 + span, out.width);
+        const int first = PLUTOFILTER_MAX(x0 - radius, 0);
+        const int count = PLUTOFILTER_MIN(x1 + radius, out.width) - first;
+
+        memset(columns, 0, count * sizeof(plutofilter__column_histogram_t));
+        for(int y = 0; y < radius && y < out.height; y++) {
+            plutofilter__column_histogram_update(columns, in.pixels + y * in.stride + first, count, shift, 1);
+        }
 
-        amount * 0.2126f,
-        inv_amount + amount * 0.7152f,
-        amount * 0.0722f,
-        0.0f,
-        0.0f,
+        for(int y = 0; y < out.height; y++) {
+            if(y - radius - 1 >= 0)
+                plutofilter__column_histogram_update(columns, in.pixels + (y - radius - 1) * in.stride + first, count, shift, -1);
+            if(y + radius < out.height)
+                plutofilter__column_histogram_update(columns, in.pixels + (y + radius) * in.stride + first, count, shift, 1);
+            const int rows = PLUTOFILTER_MIN(y + radius, out.height - 1) - PLUTOFILTER_MAX(y - radius, 0) + 1;
 
-        amount * 0.2126f,
-        amount * 0.7152f,
-        inv_amount + amount * 0.0722f,
-        0.0f,
-        0.0f,
+            memset(&kernel, 0, sizeof(kernel));
+            for(int x = first; x <= x0 + radius && x < out.width; x++) {
+                plutofilter__kernel_histogram_add(&kernel, &columns[x - first]);
+            }
 
-        0.0f,
-        0.0f,
-        0.0f,
-        1.0f,
-        0.0f
-    };
+            uint32_t* row = out.pixels + y * out.stride;
+            for(int x = x0; x < x1; x++) {
+                const int left = x - radius - 1;
+                const int right = x + radius;
+                if(x == x0) {
+                    // The window of the first column was filled above.
+                } else if(left >= 0 && right < out.width) {
+                    plutofilter__kernel_histogram_slide(&kernel, &columns[right - first], &columns[left - first]);
+                } else if(right < out.width) {
+                    plutofilter__kernel_histogram_add(&kernel, &columns[right - first]);
+                } else if(left >= 0) {
+                    plutofilter__column_histogram_t empty = {{0}, {0}};
+                    plutofilter__kernel_histogram_slide(&kernel, &empty, &columns[left - first]);
+                }
 
-    plutofilter_color_transform(in, out, matrix);
+                const int cols = PLUTOFILTER_MIN(right, out.width - 1) - PLUTOFILTER_MAX(x - radius, 0) + 1;
+                const uint32_t value = plutofilter__kernel_histogram_select(&kernel, rows * cols / 2);
+                if(shift == 24) {
+                    row[x] = value << 24;
+                } else {
+                    row[x] |= PLUTOFILTER_MIN(value, PLUTOFILTER_ALPHA(row[x])) << shift;
+                }
+            }
+        }
+    }
 }
 
-void plutofilter_color_transform_sepia(plutofilter_surface_t in, plutofilter_surface_t out, float amount)
+void plutofilter_median(plutofilter_surface_t in, plutofilter_surface_t out, int radius)
 {
-    const float inv_amount = 1.0f - amount;
-    const float matrix[] = {
-        0.393f + 0.607f * inv_amount,
-        0.769f - 0.769f * inv_amount,
-        0.189f - 0.189f * inv_amount,
-        0.0f,
-        0.0f,
-
-        0.349f - 0.349f * inv_amount,
-        0.686f + 0.314f * inv_amount,
-        0.168f - 0.168f * inv_amount,
-        0.0f,
-        0.0f,
+    PLUTOFILTER_OVERLAP_SURFACE(in, out);
 
-        0.272f - 0.272f * inv_amount,
-        0.534f - 0.534f * inv_amount,
-        0.131f + 0.869f * inv_amount,
-        0.0f,
-        0.0f,
+    if(radius <= 0) {
+        plutofilter__copy_surface(in, out);
+        return;
+    }
 
-        0.0f,
-        0.0f,
-        0.0f,
-        1.0f,
-        0.0f
-    };
+    if(radius > PLUTOFILTER_MEDIAN_MAX_RADIUS)
+        radius = PLUTOFILTER_MEDIAN_MAX_RADIUS;
 
-    plutofilter_color_transform(in, out, matrix);
+    // Alpha goes first, so each color channel can be clamped to it as it is written.
+    plutofilter__median_channel(in, out, radius, 24);
+    plutofilter__median_channel(in, out, radius, 16);
+    plutofilter__median_channel(in, out, radius, 8);
+    plutofilter__median_channel(in, out, radius, 0);
 }
 
-static inline float plutofilter__deg2rad(float angle) { return angle * (3.14159265358979323846f / 180.0f); }
+// Each grid cell holds the sums of the premultiplied channels of the pixels splatted into it, and their count.
+#define PLUTOFILTER_BILATERAL_CHANNELS 5
 
-void plutofilter_color_transform_hue_rotate(plutofilter_surface_t in, plutofilter_surface_t out, float angle)
+static void plutofilter__bilateral_grid_size(int width, int height, float spatial_sigma, float range_sigma, int* spatial, int* range, int* size)
 {
-    const float a1 = cos(plutofilter__deg2rad(angle));
-    const float a2 = sin(plutofilter__deg2rad(angle));
-    const float matrix[] = {
-        0.213f + a1 * 0.787f - a2 * 0.213f,
-        0.715f - a1 * 0.715f - a2 * 0.715f,
-        0.072f - a1 * 0.072f + a2 * 0.928f,
-        0.0f,
-        0.0f,
-
-        0.213f - a1 * 0.213f + a2 * 0.143f,
-        0.715f + a1 * 0.285f + a2 * 0.140f,
-        0.072f - a1 * 0.072f - a2 * 0.283f,
-        0.0f,
-        0.0f,
-
-        0.213f - a1 * 0.213f - a2 * 0.787f,
-        0.715f - a1 * 0.715f + a2 * 0.715f,
-        0.072f + a1 * 0.928f + a2 * 0.072f,
-        0.0f,
-        0.0f,
+    *spatial = (int)PLUTOFILTER_CLAMP(spatial_sigma + 0.5f, 1.f, 256.f);
+    *range = (int)PLUTOFILTER_CLAMP(range_sigma * 255.f + 0.5f, 1.f, 255.f);
+    size[0] = (PLUTOFILTER_MAX(width, 1) - 1) / *spatial + 2;
+    size[1] = (PLUTOFILTER_MAX(height, 1) - 1) / *spatial + 2;
+    size[2] = 255 / *range + 2;
+}
 
-        0.0f,
-        0.0f,
-        0.0f,
-        1.0f,
-        0.0f
-    };
+size_t plutofilter_bilateral_scratch_size(int width, int height, float spatial_sigma, float range_sigma)
+{
+    int spatial, range, size[3];
+    plutofilter__bilateral_grid_size(width, height, spatial_sigma, range_sigma, &spatial, &range, size);
+    return (size_t)size[0] * size[1] * size[2] * PLUTOFILTER_BILATERAL_CHANNELS;
+}
 
-    plutofilter_color_transform(in, out, matrix);
+// Blurs the grid along one axis with the [1 2 1] kernel, in place. Cells beyond the grid are empty.
+static void plutofilter__bilateral_grid_blur(uint32_t* grid, int count, int step, int length)
+{
+    for(int line = 0; line < count / length; line++) {
+        uint32_t* cell = grid + (line / step) * step * length * PLUTOFILTER_BILATERAL_CHANNELS + (line % step) * PLUTOFILTER_BILATERAL_CHANNELS;
+        const size_t stride = (size_t)step * PLUTOFILTER_BILATERAL_CHANNELS;
+        for(int c = 0; c < PLUTOFILTER_BILATERAL_CHANNELS; c++) {
+            uint32_t previous = 0;
+            for(int i = 0; i < length; i++) {
+                const uint32_t current = cell[i * stride + c];
+                const uint32_t next = i + 1 < length ? cell[(i + 1) * stride + c] : 0;
+                cell[i * stride + c] = previous + 2 * current + next;
+                previous = current;
+            }
+        }
+    }
 }
 
-void plutofilter_color_transform_luminance_to_alpha(plutofilter_surface_t in, plutofilter_surface_t out)
+void plutofilter_bilateral(plutofilter_surface_t in, plutofilter_surface_t out, float spatial_sigma, float range_sigma, uint32_t* scratch)
 {
     PLUTOFILTER_OVERLAP_SURFACE(in, out);
 
+    int spatial, range, size[3];
+    plutofilter__bilateral_grid_size(out.width, out.height, spatial_sigma, range_sigma, &spatial, &range, size);
+    const int cells = size[0] * size[1] * size[2];
+    memset(scratch, 0, (size_t)cells * PLUTOFILTER_BILATERAL_CHANNELS * sizeof(uint32_t));
+
+    // Splat each pixel into its nearest cell. Cells are laid out with luminance varying fastest, so the
+    // cells read by one trilinear lookup are close together.
     for(int y = 0; y < out.height; y++) {
+        const int j = (y + spatial / 2) / spatial;
+        const uint32_t* row = in.pixels + y * in.stride;
         for(int x = 0; x < out.width; x++) {
-            PLUTOFILTER_INIT_LOAD_PIXEL(in, x, y, r, g, b, a);
-            PLUTOFILTER_UNPREMULTIPLY_PIXEL(r, g, b, a);
+            const uint32_t pixel = row[x];
+            const int i = (x + spatial / 2) / spatial;
+            const int k = (int)(plutofilter__luminance(pixel) + range / 2) / range;
+            uint32_t* cell = scratch + ((size_t)(j * size[0] + i) * size[2] + k) * PLUTOFILTER_BILATERAL_CHANNELS;
+            cell[0] += PLUTOFILTER_RED(pixel);
+            cell[1] += PLUTOFILTER_GREEN(pixel);
+            cell[2] += PLUTOFILTER_BLUE(pixel);
+            cell[3] += PLUTOFILTER_ALPHA(pixel);
+            cell[4] += 1;
+        }
+    }
 
-            float l = r * 0.2125f + g * 0.7154f + b * 0.0721f;
+    plutofilter__bilateral_grid_blur(scratch, cells, 1, size[2]);
+    plutofilter__bilateral_grid_blur(scratch, cells, size[2], size[0]);
+    plutofilter__bilateral_grid_blur(scratch, cells, size[2] * size[0], size[1]);
 
-            PLUTOFILTER_STORE_PIXEL(out, x, y, 0, 0, 0, PLUTOFILTER_CLAMP_PIXEL(l));
+    // Slice the grid at each pixel's position and luminance. The ratio of interpolated sums to interpolated
+    // counts is the weighted average of the pixels near it in both space and luminance.
+    const size_t step_i = (size_t)size[2] * PLUTOFILTER_BILATERAL_CHANNELS;
+    const size_t step_j = step_i * size[0];
+    for(int y = 0; y < out.height; y++) {
+        const int j = y / spatial;
+        const float fy = (float)(y - j * spatial) / spatial;
+        for(int x = 0; x < out.width; x++) {
+            const uint32_t pixel = PLUTOFILTER_GET_PIXEL(in, x, y);
+            const int i = x / spatial;
+            const float fx = (float)(x - i * spatial) / spatial;
+            const int luminance = plutofilter__luminance(pixel);
+            const int k = luminance / range;
+            const float fz = (float)(luminance - k * range) / range;
+
+            const uint32_t* base = scratch + (j * step_j + i * step_i) + (size_t)k * PLUTOFILTER_BILATERAL_CHANNELS;
+            float sums[PLUTOFILTER_BILATERAL_CHANNELS] = {0};
+            for(int corner = 0; corner < 8; corner++) {
+                const float weight = ((corner & 1) ? fz : 1.f - fz) * ((corner & 2) ? fx : 1.f - fx) * ((corner & 4) ? fy : 1.f - fy);
+                const uint32_t* cell = base + ((corner & 1) ? PLUTOFILTER_BILATERAL_CHANNELS : 0) + ((corner & 2) ? step_i : 0) + ((corner & 4) ? step_j : 0);
+                for(int c = 0; c < PLUTOFILTER_BILATERAL_CHANNELS; c++) {
+                    sums[c] += weight * cell[c];
+                }
+            }
+
+            if(sums[4] <= 0.f) {
+                PLUTOFILTER_GET_PIXEL(out, x, y) = pixel;
+                continue;
+            }
+
+            const float scale = 1.f / sums[4];
+            const uint32_t a = (uint32_t)PLUTOFILTER_MIN(sums[3] * scale + 0.5f, 255.f);
+            const uint32_t r = (uint32_t)PLUTOFILTER_MIN(sums[0] * scale + 0.5f, (float)a);
+            const uint32_t g = (uint32_t)PLUTOFILTER_MIN(sums[1] * scale + 0.5f, (float)a);
+            const uint32_t b = (uint32_t)PLUTOFILTER_MIN(sums[2] * scale + 0.5f, (float)a);
+            PLUTOFILTER_STORE_PIXEL(out, x, y, r, g, b, a);
         }
     }
 }
 
-static const uint8_t PLUTOFILTER_SRGB_TO_LINEAR_RGB_TABLE[256] = {
-    0,   0,   0,   0,   0,   0,  0,    1,   1,   1,   1,   1,   1,   1,   1,   1,
-    1,   1,   2,   2,   2,   2,  2,    2,   2,   2,   3,   3,   3,   3,   3,   3,
-    4,   4,   4,   4,   4,   5,  5,    5,   5,   6,   6,   6,   6,   7,   7,   7,
-    8,   8,   8,   8,   9,   9,  9,   10,  10,  10,  11,  11,  12,  12,  12,  13,
-    13,  13,  14,  14,  15,  15,  16,  16,  17,  17,  17,  18,  18,  19,  19,  20,
-    20,  21,  22,  22,  23,  23,  24,  24,  25,  25,  26,  27,  27,  28,  29,  29,
-    30,  30,  31,  32,  32,  33,  34,  35,  35,  36,  37,  37,  38,  39,  40,  41,
-    41,  42,  43,  44,  45,  45,  46,  47,  48,  49,  50,  51,  51,  52,  53,  54,
-    55,  56,  57,  58,  59,  60,  61,  62,  63,  64,  65,  66,  67,  68,  69,  70,
-    71,  72,  73,  74,  76,  77,  78,  79,  80,  81,  82,  84,  85,  86,  87,  88,
-    90,  91,  92,  93,  95,  96,  97,  99, 100, 101, 103, 104, 105, 107, 108, 109,
-    111, 112, 114, 115, 116, 118, 119, 121, 122, 124, 125, 127, 128, 130, 131, 133,
-    134, 136, 138, 139, 141, 142, 144, 146, 147, 149, 151, 152, 154, 156, 157, 159,
-    161, 163, 164, 166, 168, 170, 171, 173, 175, 177, 179, 181, 183, 184, 186, 188,
-    190, 192, 194, 196, 198, 200, 202, 204, 206, 208, 210, 212, 214, 216, 218, 220,
-    222, 224, 226, 229, 231, 233, 235, 237, 239, 242, 244, 246, 248, 250, 253, 255,
-};
+// Edge detection works on chunks of columns, so its row buffers have a fixed size whatever the surface width.
+#define PLUTOFILTER_EDGE_CHUNK 1024
 
-#define PLUTOFILTER_SRGB_TO_LINEAR_RGB(r, g, b) \
-    do { \
-        (r) = PLUTOFILTER_SRGB_TO_LINEAR_RGB_TABLE[r]; \
-        (g) = PLUTOFILTER_SRGB_TO_LINEAR_RGB_TABLE[g]; \
-        (b) = PLUTOFILTER_SRGB_TO_LINEAR_RGB_TABLE[b]; \
-    } while(0)
+static void plutofilter__edge_luminance_row(plutofilter_surface_t in, int y, int x0, int count, int16_t* luminance)
+{
+    const uint32_t* row = in.pixels + y * in.stride;
+    luminance[0] = (int16_t)plutofilter__luminance(row[PLUTOFILTER_MAX(x0 - 1, 0)]);
+    for(int i = 0; i < count; i++)
+        luminance[i + 1] = (int16_t)plutofilter__luminance(row[x0 + i]);
+    luminance[count + 1] = (int16_t)plutofilter__luminance(row[PLUTOFILTER_MIN(x0 + count, in.width - 1)]);
+}
+
+// Writes the gradient magnitude of each row into `out`, or into the opaque gray pixels of `surface` when `out` is NULL.
+static void plutofilter__edge_detect(plutofilter_surface_t in, plutofilter_edge_operator_t op, uint8_t* out, uint32_t stride, plutofilter_surface_t surface)
+{
+    int16_t buffers[3][PLUTOFILTER_EDGE_CHUNK + 2];
+    int16_t gradient_x[PLUTOFILTER_EDGE_CHUNK];
+    int16_t gradient_y[PLUTOFILTER_EDGE_CHUNK];
+    uint8_t magnitudes[PLUTOFILTER_EDGE_CHUNK];
+
+    if(in.width == 0 || in.height == 0)
+        return;
+    const int16_t side = op == PLUTOFILTER_EDGE_OPERATOR_SCHARR ? 3 : 1;
+    const int16_t center = op == PLUTOFILTER_EDGE_OPERATOR_SCHARR ? 10 : 2;
+    // The divisor is 4 or 16, so its square is applied as a shift, and the squared odd numbers that bound each
+    // level stay exact in floats; the correction below needs no integer multiplies.
+    const int divisor_shift = op == PLUTOFILTER_EDGE_OPERATOR_SCHARR ? 8 : 4;
+    const float scale = 1.f / (2 * side + center);
+
+    for(int x0 = 0; x0 < in.width; x0 += PLUTOFILTER_EDGE_CHUNK) {
+        const int count = PLUTOFILTER_MIN(PLUTOFILTER_EDGE_CHUNK, in.width - x0);
+        int16_t* above = buffers[0];
+        int16_t* middle = buffers[1];
+        int16_t* below = buffers[2];
+        plutofilter__edge_luminance_row(in, 0, x0, count, middle);
+        memcpy(above, middle, (count + 2) * sizeof(int16_t));
+        plutofilter__edge_luminance_row(in, PLUTOFILTER_MIN(1, in.height - 1), x0, count, below);
+
+        for(int y = 0; y < in.height; y++) {
+            for(int i = 0; i < count; i++) {
+                gradient_x[i] = (int16_t)(side * (above[i + 2] - above[i]) + center * (middle[i + 2] - middle[i]) + side * (below[i + 2] - below[i]));
+                gradient_y[i] = (int16_t)(side * (below[i] - above[i]) + center * (below[i + 1] - above[i + 1]) + side * (below[i + 2] - above[i + 2]));
+            }
+
+            // The estimate from the reciprocal square root is off by at most one, and is corrected to the exact rounding
+            // of sqrt(squared) / divisor: the largest level with ((2 * level - 1) * divisor)^2 <= 4 * squared.
+            for(int i = 0; i < count; i++) {
+                const int squared = gradient_x[i] * gradient_x[i] + gradient_y[i] * gradient_y[i];
+                const float estimate = (float)squared * plutofilter__rsqrt((float)squared) * scale + 0.5f;
+                int level = (int)estimate;
+                const float upper = 2.f * level + 1.f;
+                const float lower = 2.f * level - 1.f;
+                level += ((int)(upper * upper) << divisor_shift) <= (squared << 2);
+                level -= (level > 0) & (((int)(lower * lower) << divisor_shift) > (squared << 2));
+                magnitudes[i] = (uint8_t)PLUTOFILTER_MIN(level, 255);
+            }
+
+            if(out) {
+                memcpy(out + (size_t)y * stride + x0, magnitudes, count);
+            } else {
+                uint32_t* row = surface.pixels + y * surface.stride + x0;
+                for(int i = 0; i < count; i++) {
+                    row[i] = 0xFF000000u | magnitudes[i] * 0x010101u;
+                }
+            }
+
+            int16_t* next = above;
+            above = middle;
+            middle = below;
+            below = next;
+            plutofilter__edge_luminance_row(in, PLUTOFILTER_MIN(y + 2, in.height - 1), x0, count, below);
+        }
+    }
+}
 
-void plutofilter_color_transform_srgb_to_linear_rgb(plutofilter_surface_t in, plutofilter_surface_t out)
+void plutofilter_edge_detect(plutofilter_surface_t in, plutofilter_surface_t out, plutofilter_edge_operator_t op)
 {
     PLUTOFILTER_OVERLAP_SURFACE(in, out);
+    plutofilter__edge_detect(in, op, NULL, 0, out);
+}
 
-    for(int y = 0; y < out.height; y++) {
-        for(int x = 0; x < out.width; x++) {
-            PLUTOFILTER_INIT_LOAD_PIXEL(in, x, y, r, g, b, a);
-            PLUTOFILTER_UNPREMULTIPLY_PIXEL(r, g, b, a);
+void plutofilter_edge_detect_a8(plutofilter_surface_t in, uint8_t* out, uint32_t stride, plutofilter_edge_operator_t op)
+{
+    plutofilter__edge_detect(in, op, out, stride, in);
+}
 
-            PLUTOFILTER_SRGB_TO_LINEAR_RGB(r, g, b);
+// Consecutive pixels go to different sub-histograms, so increments of equal values do not wait on each other.
+#define PLUTOFILTER_HISTOGRAM_LANES 4
 
-            PLUTOFILTER_PREMULTIPLY_PIXEL(r, g, b, a);
-            PLUTOFILTER_STORE_PIXEL(out, x, y, r, g, b, a);
+void plutofilter_histogram(plutofilter_surface_t in, plutofilter_histogram_t* histogram, int unpremultiply)
+{
+    uint32_t lanes[PLUTOFILTER_HISTOGRAM_LANES][4][256];
+    memset(lanes, 0, sizeof(lanes));
+
+    for(int y = 0; y < in.height; y++) {
+        const uint32_t* row = in.pixels + y * in.stride;
+        for(int x = 0; x < in.width; x++) {
+            uint32_t (*counts)[256] = lanes[x % PLUTOFILTER_HISTOGRAM_LANES];
+            uint32_t r, g, b, a;
+            PLUTOFILTER_UNPACK_PIXEL(row[x], r, g, b, a);
+            if(unpremultiply && a != 255) {
+                PLUTOFILTER_UNPREMULTIPLY_PIXEL(r, g, b, a);
+            }
+
+            counts[PLUTOFILTER_CHANNEL_R][r]++;
+            counts[PLUTOFILTER_CHANNEL_G][g]++;
+            counts[PLUTOFILTER_CHANNEL_B][b]++;
+            counts[PLUTOFILTER_CHANNEL_A][a]++;
         }
     }
-}
 
-static const uint8_t PLUTOFILTER_LINEAR_RGB_TO_SRGB_TABLE[256] = {
-    0,  13,  22,  28,  34,  38,  42,  46,  50,  53,  56,  59,  61,  64,  66,  69,
-    71,  73,  75,  77,  79,  81,  83,  85,  86,  88,  90,  92,  93,  95,  96,  98,
-    99, 101, 102, 104, 105, 106, 108, 109, 110, 112, 113, 114, 115, 117, 118, 119,
-    120, 121, 122, 124, 125, 126, 127, 128, 129, 130, 131, 132, 133, 134, 135, 136,
-    137, 138, 139, 140, 141, 142, 143, 144, 145, 146, 147, 148, 148, 149, 150, 151,
-    152, 153, 154, 155, 155, 156, 157, 158, 159, 159, 160, 161, 162, 163, 163, 164,
-    165, 166, 167, 167, 168, 169, 170, 170, 171, 172, 173, 173, 174, 175, 175, 176,
-    177, 178, 178, 179, 180, 180, 181, 182, 182, 183, 184, 185, 185, 186, 187, 187,
-    188, 189, 189, 190, 190, 191, 192, 192, 193, 194, 194, 195, 196, 196, 197, 197,
-    198, 199, 199, 200, 200, 201, 202, 202, 203, 203, 204, 205, 205, 206, 206, 207,
-    208, 208, 209, 209, 210, 210, 211, 212, 212, 213, 213, 214, 214, 215, 215, 216,
-    216, 217, 218, 218, 219, 219, 220, 220, 221, 221, 222, 222, 223, 223, 224, 224,
-    225, 226, 226, 227, 227, 228, 228, 229, 229, 230, 230, 231, 231, 232, 232, 233,
-    233, 234, 234, 235, 235, 236, 236, 237, 237, 238, 238, 238, 239, 239, 240, 240,
-    241, 241, 242, 242, 243, 243, 244, 244, 245, 245, 246, 246, 246, 247, 247, 248,
-    248, 249, 249, 250, 250, 251, 251, 251, 252, 252, 253, 253, 254, 254, 255, 255,
-};
+    for(int channel = 0; channel < 4; channel++) {
+        for(int value = 0; value < 256; value++) {
+            uint32_t count = 0;
+            for(int lane = 0; lane < PLUTOFILTER_HISTOGRAM_LANES; lane++)
+                count += lanes[lane][channel][value];
+            histogram->counts[channel][value] = count;
+        }
+    }
 
-#define PLUTOFILTER_LINEAR_RGB_TO_SRGB(r, g, b) \
-    do { \
-        (r) = PLUTOFILTER_LINEAR_RGB_TO_SRGB_TABLE[r]; \
-        (g) = PLUTOFILTER_LINEAR_RGB_TO_SRGB_TABLE[g]; \
-        (b) = PLUTOFILTER_LINEAR_RGB_TO_SRGB_TABLE[b]; \
-    } while(0)
+    histogram->total = (uint32_t)in.width * in.height;
+}
 
-void plutofilter_color_transform_linear_rgb_to_srgb(plutofilter_surface_t in, plutofilter_surface_t out)
+void plutofilter_stats(plutofilter_surface_t in, plutofilter_stats_t* stats, int unpremultiply)
 {
-    PLUTOFILTER_OVERLAP_SURFACE(in, out);
-
-    for(int y = 0; y < out.height; y++) {
-        for(int x = 0; x < out.width; x++) {
-            PLUTOFILTER_INIT_LOAD_PIXEL(in, x, y, r, g, b, a);
-            PLUTOFILTER_UNPREMULTIPLY_PIXEL(r, g, b, a);
+    plutofilter_histogram_t histogram;
+    plutofilter_histogram(in, &histogram, unpremultiply);
+    memset(stats, 0, sizeof(plutofilter_stats_t));
+    if(histogram.total == 0)
+        return;
 
-            PLUTOFILTER_LINEAR_RGB_TO_SRGB(r, g, b);
+    for(int channel = 0; channel < 4; channel++) {
+        const uint32_t* counts = histogram.counts[channel];
+        int min = 0;
+        while(counts[min] == 0)
+            min++;
+        int max = 255;
+        while(counts[max] == 0) {
+            max--;
+        }
 
-            PLUTOFILTER_PREMULTIPLY_PIXEL(r, g, b, a);
-            PLUTOFILTER_STORE_PIXEL(out, x, y, r, g, b, a);
+        double sum = 0.0;
+        double sum_squares = 0.0;
+        for(int value = min; value <= max; value++) {
+            sum += (double)counts[value] * value;
+            sum_squares += (double)counts[value] * value * value;
         }
+
+        const double mean = sum / histogram.total;
+        stats->min[channel] = (uint8_t)min;
+        stats->max[channel] = (uint8_t)max;
+        stats->mean[channel] = (float)mean;
+        stats->standard_deviation[channel] = (float)sqrt(PLUTOFILTER_MAX(sum_squares / histogram.total - mean * mean, 0.0));
     }
 }
 
-#define PLUTOFILTER_BLUR_STORE_PIXEL(out, x, y, r, g, b, a, k) \
-    PLUTOFILTER_STORE_PIXEL(out, x, y, (r) / (k), (g) / (k), (b) / (k), (a) / (k))
+static void plutofilter__identity_table(uint8_t* table)
+{
+    for(int value = 0; value < 256; value++) {
+        table[value] = (uint8_t)value;
+    }
+}
 
-#define PLUTOFILTER_MIN(a, b) ((a) < (b) ? (a) : (b))
-#define PLUTOFILTER_MAX(a, b) ((a) > (b) ? (a) : (b))
+// Builds the unpremultiplied histogram of the pixels that are not fully transparent. Those unpremultiply to
+// black, so they are exactly the alpha 0 count in the zero bin of each color channel.
+static void plutofilter__visible_histogram(plutofilter_surface_t in, plutofilter_histogram_t* histogram)
+{
+    plutofilter_histogram(in, histogram, 1);
+    const uint32_t transparent = histogram->counts[PLUTOFILTER_CHANNEL_A][0];
+    for(int channel = PLUTOFILTER_CHANNEL_R; channel <= PLUTOFILTER_CHANNEL_B; channel++)
+        histogram->counts[channel][0] -= transparent;
+    histogram->counts[PLUTOFILTER_CHANNEL_A][0] = 0;
+    histogram->total -= transparent;
+}
 
-static void plutofilter__box_blur(plutofilter_surface_t in, plutofilter_surface_t out, uint32_t* intermediate, int kernel_width, int kernel_height)
+void plutofilter_auto_levels(plutofilter_surface_t in, plutofilter_surface_t out, float clip)
 {
-    int x, y, offset;
-    uint32_t pixel, r, g, b, a;
-    uint32_t sum_r, sum_g, sum_b, sum_a;
+    PLUTOFILTER_OVERLAP_SURFACE(in, out);
 
-    if(kernel_width > 0) {
-        kernel_width = PLUTOFILTER_MIN(kernel_width, out.width);
-        for(y = 0; y < out.height; y++) {
-            sum_r = sum_g = sum_b = sum_a = 0;
-            for(x = 0; x < kernel_width; x++) {
-                pixel = (intermediate[x % kernel_width] = PLUTOFILTER_GET_PIXEL(in, x, y));
-                PLUTOFILTER_UNPACK_PIXEL(pixel, r, g, b, a);
+    plutofilter_histogram_t histogram;
+    plutofilter__visible_histogram(in, &histogram);
+
+    uint8_t tables[4][256];
+    const uint32_t limit = (uint32_t)(PLUTOFILTER_CLAMP(clip, 0.f, 0.5f) * histogram.total);
+    for(int channel = PLUTOFILTER_CHANNEL_R; channel <= PLUTOFILTER_CHANNEL_B; channel++) {
+        const uint32_t* counts = histogram.counts[channel];
+        int low = 0;
+        uint32_t below = counts[0];
+        while(low < 255 && below <= limit)
+            below += counts[++low];
+        int high = 255;
+        uint32_t above = counts[255];
+        while(high > 0 && above <= limit) {
+            above += counts[--high];
+        }
 
-                sum_r += r;
-                sum_g += g;
-                sum_b += b;
-                sum_a += a;
+        if(high <= low) {
+            plutofilter__identity_table(tables[channel]);
+            continue;
+        }
 
-                offset = x - kernel_width / 2;
-                if(offset >= 0 && offset < out.width) {
-                    PLUTOFILTER_BLUR_STORE_PIXEL(out, offset, y, sum_r, sum_g, sum_b, sum_a, kernel_width);
-                }
-            }
+        for(int value = 0; value < 256; value++) {
+            const int level = ((value - low) * 255 + (high - low) / 2) / (high - low);
+            tables[channel][value] = (uint8_t)PLUTOFILTER_CLAMP(level, 0, 255);
+        }
+    }
 
-            for(x = kernel_width; x < out.width; x++) {
-                pixel = intermediate[x % kernel_width];
-                PLUTOFILTER_UNPACK_PIXEL(pixel, r, g, b, a);
+    plutofilter__identity_table(tables[PLUTOFILTER_CHANNEL_A]);
+    plutofilter_color_transform_table(in, out, (const uint8_t (*)[256])tables);
+}
 
-                sum_r -= r;
-                sum_g -= g;
-                sum_b -= b;
-                sum_a -= a;
+void plutofilter_equalize(plutofilter_surface_t in, plutofilter_surface_t out)
+{
+    PLUTOFILTER_OVERLAP_SURFACE(in, out);
 
-                pixel = (intermediate[x % kernel_width] = PLUTOFILTER_GET_PIXEL(in, x, y));
-                PLUTOFILTER_UNPACK_PIXEL(pixel, r, g, b, a);
+    plutofilter_histogram_t histogram;
+    plutofilter__visible_histogram(in, &histogram);
+
+    uint8_t tables[4][256];
+    for(int channel = PLUTOFILTER_CHANNEL_R; channel <= PLUTOFILTER_CHANNEL_B; channel++) {
+        const uint32_t* counts = histogram.counts[channel];
+        int first = 0;
+        while(first < 255 && counts[first] == 0)
+            first++;
+        const uint64_t range = histogram.total - counts[first];
+        if(range == 0) {
+            plutofilter__identity_table(tables[channel]);
+            continue;
+        }
 
-                sum_r += r;
-                sum_g += g;
-                sum_b += b;
-                sum_a += a;
+        // The darkest value present maps to 0, and each value above it to its share of the remaining pixels.
+        uint64_t sum = 0;
+        for(int value = 0; value < 256; value++) {
+            sum += counts[value];
+            const uint64_t above = sum > counts[first] ? sum - counts[first] : 0;
+            tables[channel][value] = (uint8_t)((above * 255 + range / 2) / range);
+        }
+    }
 
-                offset = x - kernel_width / 2;
-                PLUTOFILTER_BLUR_STORE_PIXEL(out, offset, y, sum_r, sum_g, sum_b, sum_a, kernel_width);
-            }
+    plutofilter__identity_table(tables[PLUTOFILTER_CHANNEL_A]);
+    plutofilter_color_transform_table(in, out, (const uint8_t (*)[256])tables);
+}
 
-            for(x = out.width; x < out.width + kernel_width; x++) {
-                pixel = intermediate[x % kernel_width];
-                PLUTOFILTER_UNPACK_PIXEL(pixel, r, g, b, a);
+static const uint8_t plutofilter__bayer_matrix[8][8] = {
+    { 0, 32,  8, 40,  2, 34, 10, 42},
+    {48, 16, 56, 24, 50, 18, 58, 26},
+    {12, 44,  4, 36, 14, 46,  6, 38},
+    {60, 28, 52, 20, 62, 30, 54, 22},
+    { 3, 35, 11, 43,  1, 33,  9, 41},
+    {51, 19, 59, 27, 49, 17, 57, 25},
+    {15, 47,  7, 39, 13, 45,  5, 37},
+    {63, 31, 55, 23, 61, 29, 53, 21}
+};
 
-                sum_r -= r;
-                sum_g -= g;
-                sum_b -= b;
-                sum_a -= a;
+static inline uint32_t plutofilter__quantize_channel(float value, float threshold)
+{
+    return (uint32_t)(PLUTOFILTER_CLAMP(value, 0.f, 1.f) * 255.f + threshold);
+}
 
-                offset = x - kernel_width / 2;
-                if(offset >= 0 && offset < out.width) {
-                    PLUTOFILTER_BLUR_STORE_PIXEL(out, offset, y, sum_r, sum_g, sum_b, sum_a, kernel_width);
-                }
+static void plutofilter__quantize_floyd_steinberg(plutofilter_float_surface_t in, plutofilter_surface_t out, float* scratch)
+{
+    // The errors diffused into the current and the next row, with a pixel of padding at each end to absorb the
+    // errors that would fall outside the surface.
+    const size_t length = 4 * ((size_t)out.width + 2);
+    float* current = scratch;
+    float* next = scratch + length;
+    memset(current, 0, length * sizeof(float));
+
+    for(int y = 0; y < out.height; y++) {
+        const float* row = in.pixels + (size_t)y * in.stride * 4;
+        memset(next, 0, length * sizeof(float));
+
+        // Serpentine order keeps the diffused error from drifting in one direction.
+        const int step = (y & 1) ? -1 : 1;
+        const int start = (y & 1) ? out.width - 1 : 0;
+        for(int i = 0; i < out.width; i++) {
+            const int x = start + i * step;
+            const float* pixel = row + x * 4;
+            float* error = current + (x + 1) * 4;
+            float values[4];
+            for(int c = 0; c < 4; c++)
+                values[c] = pixel[c] + error[c];
+            const uint32_t a = plutofilter__quantize_channel(values[3], 0.5f);
+            const uint32_t r = PLUTOFILTER_MIN(plutofilter__quantize_channel(values[0], 0.5f), a);
+            const uint32_t g = PLUTOFILTER_MIN(plutofilter__quantize_channel(values[1], 0.5f), a);
+            const uint32_t b = PLUTOFILTER_MIN(plutofilter__quantize_channel(values[2], 0.5f), a);
+            PLUTOFILTER_STORE_PIXEL(out, x, y, r, g, b, a);
+
+            // Only the error within the representable range is diffused, so out-of-range values do not bleed.
+            const float errors[4] = {
+                PLUTOFILTER_CLAMP(values[0], 0.f, 1.f) - r / 255.f,
+                PLUTOFILTER_CLAMP(values[1], 0.f, 1.f) - g / 255.f,
+                PLUTOFILTER_CLAMP(values[2], 0.f, 1.f) - b / 255.f,
+                PLUTOFILTER_CLAMP(values[3], 0.f, 1.f) - a / 255.f
+            };
+
+            float* below = next + (x + 1) * 4;
+            for(int c = 0; c < 4; c++) {
+                error[step * 4 + c] += errors[c] * (7.f / 16.f);
+                below[-step * 4 + c] += errors[c] * (3.f / 16.f);
+                below[c] += errors[c] * (5.f / 16.f);
+                below[step * 4 + c] += errors[c] * (1.f / 16.f);
             }
         }
+
+        float* swap = current;
+        current = next;
+        next = swap;
     }
+}
 
-    if(kernel_height > 0) {
-        kernel_height = PLUTOFILTER_MIN(kernel_height, out.height);
-        for(x = 0; x < out.width; x++) {
-            sum_r = sum_g = sum_b = sum_a = 0;
-            for(y = 0; y < kernel_height; y++) {
-                pixel = (intermediate[y % kernel_height] = PLUTOFILTER_GET_PIXEL(in, x, y));
-                PLUTOFILTER_UNPACK_PIXEL(pixel, r, g, b, a);
+void plutofilter_quantize(plutofilter_float_surface_t in, plutofilter_surface_t out, plutofilter_dither_t dither, float* scratch)
+{
+    PLUTOFILTER_OVERLAP_SURFACE(in, out);
 
-                sum_r += r;
-                sum_g += g;
-                sum_b += b;
-                sum_a += a;
+    if(dither == PLUTOFILTER_DITHER_FLOYD_STEINBERG) {
+        plutofilter__quantize_floyd_steinberg(in, out, scratch);
+        return;
+    }
 
-                offset = y - kernel_height / 2;
-                if(offset >= 0 && offset < out.height) {
-                    PLUTOFILTER_BLUR_STORE_PIXEL(out, x, offset, sum_r, sum_g, sum_b, sum_a, kernel_height);
-                }
-            }
+    for(int y = 0; y < out.height; y++) {
+        const float* row = in.pixels + (size_t)y * in.stride * 4;
+        const uint8_t* pattern = plutofilter__bayer_matrix[y & 7];
+        for(int x = 0; x < out.width; x++) {
+            const float* pixel = row + x * 4;
+            const float threshold = dither == PLUTOFILTER_DITHER_ORDERED ? (pattern[x & 7] + 0.5f) / 64.f : 0.5f;
+            const uint32_t a = plutofilter__quantize_channel(pixel[3], threshold);
+            const uint32_t r = PLUTOFILTER_MIN(plutofilter__quantize_channel(pixel[0], threshold), a);
+            const uint32_t g = PLUTOFILTER_MIN(plutofilter__quantize_channel(pixel[1], threshold), a);
+            const uint32_t b = PLUTOFILTER_MIN(plutofilter__quantize_channel(pixel[2], threshold), a);
+            PLUTOFILTER_STORE_PIXEL(out, x, y, r, g, b, a);
+        }
+    }
+}
 
-            for(y = kernel_height; y < out.height; y++) {
-                pixel = intermediate[y % kernel_height];
-                PLUTOFILTER_UNPACK_PIXEL(pixel, r, g, b, a);
+#define PLUTOFILTER_TONE_MAP_TABLE_SIZE 4096
 
-                sum_r -= r;
-                sum_g -= g;
-                sum_b -= b;
-                sum_a -= a;
+static inline float plutofilter__hable_curve(float x)
+{
+    const float a = 0.15f, b = 0.50f, c = 0.10f, d = 0.20f, e = 0.02f, f = 0.30f;
+    return (x * (a * x + c * b) + d * e) / (x * (a * x + b) + d * f) - e / f;
+}
 
-                pixel = (intermediate[y % kernel_height] = PLUTOFILTER_GET_PIXEL(in, x, y));
-                PLUTOFILTER_UNPACK_PIXEL(pixel, r, g, b, a);
+static inline float plutofilter__tone_map_curve(float x, plutofilter_tone_map_t tone_map)
+{
+    switch(tone_map) {
+    case PLUTOFILTER_TONE_MAP_REINHARD:
+        return x / (1.f + x);
+    case PLUTOFILTER_TONE_MAP_ACES:
+        return (x * (2.51f * x + 0.03f)) / (x * (2.43f * x + 0.59f) + 0.14f);
+    case PLUTOFILTER_TONE_MAP_HABLE:
+        return plutofilter__hable_curve(x) / plutofilter__hable_curve(11.2f);
+    default:
+        return x;
+    }
+}
 
-                sum_r += r;
-                sum_g += g;
-                sum_b += b;
-                sum_a += a;
+void plutofilter_tone_map(plutofilter_float_surface_t in, plutofilter_surface_t out, plutofilter_tone_map_t tone_map, float exposure)
+{
+    PLUTOFILTER_OVERLAP_SURFACE(in, out);
 
-                offset = y - kernel_height / 2;
-                PLUTOFILTER_BLUR_STORE_PIXEL(out, x, offset, sum_r, sum_g, sum_b, sum_a, kernel_height);
-            }
+    // The tone curve brings every channel into [0, 1], where a table finer than the 8-bit output replaces powf.
+    uint8_t encode[PLUTOFILTER_TONE_MAP_TABLE_SIZE + 1];
+    for(int i = 0; i <= PLUTOFILTER_TONE_MAP_TABLE_SIZE; i++) {
+        const float c = (float)i / PLUTOFILTER_TONE_MAP_TABLE_SIZE;
+        const float srgb = c <= 0.0031308f ? c * 12.92f : 1.055f * powf(c, 1.f / 2.4f) - 0.055f;
+        encode[i] = (uint8_t)(srgb * 255.f + 0.5f);
+    }
 
-            for(y = out.height; y < out.height + kernel_height; y++) {
-                pixel = intermediate[y % kernel_height];
-                PLUTOFILTER_UNPACK_PIXEL(pixel, r, g, b, a);
+    for(int y = 0; y < out.height; y++) {
+        const float* row = in.pixels + (size_t)y * in.stride * 4;
+        for(int x = 0; x < out.width; x++) {
+            const float* sample = row + x * 4;
+            const float alpha = PLUTOFILTER_CLAMP(sample[3], 0.f, 1.f);
+            const uint32_t a = (uint32_t)(alpha * 255.f + 0.5f);
+            if(a == 0) {
+                out.pixels[y * out.stride + x] = 0;
+                continue;
+            }
 
-                sum_r -= r;
-                sum_g -= g;
-                sum_b -= b;
-                sum_a -= a;
+            const float scale = exposure / alpha;
+            uint32_t channels[3];
+            for(int c = 0; c < 3; c++) {
+                const float mapped = plutofilter__tone_map_curve(PLUTOFILTER_MAX(sample[c] * scale, 0.f), tone_map);
+                channels[c] = encode[(int)(PLUTOFILTER_MIN(mapped, 1.f) * PLUTOFILTER_TONE_MAP_TABLE_SIZE + 0.5f)];
+            }
 
-                offset = y - kernel_height / 2;
-                if(offset >= 0 && offset < out.height) {
-                    PLUTOFILTER_BLUR_STORE_PIXEL(out, x, offset, sum_r, sum_g, sum_b, sum_a, kernel_height);
-                }
+            uint32_t r = channels[0], g = channels[1], b = channels[2];
+            if(a != 255) {
+                PLUTOFILTER_PREMULTIPLY_PIXEL(r, g, b, a);
             }
+
+            PLUTOFILTER_STORE_PIXEL(out, x, y, r, g, b, a);
         }
     }
 }
 
-#define PLUTOFILTER_KERNEL_FACTOR 1.8799712059732503f
+// SplitMix64: each row is a stream keyed by the seed, frame and row, and each pixel a counter within it.
+#define PLUTOFILTER_SPLITMIX_GAMMA 0x9E3779B97F4A7C15ull
 
-static inline int plutofilter__calc_kernel_size(float std_deviation)
+static inline uint64_t plutofilter__splitmix64(uint64_t z)
 {
-    return (int)(floorf(std_deviation * PLUTOFILTER_KERNEL_FACTOR + 0.5f));
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return z ^ (z >> 31);
 }
 
-#define PLUTOFILTER_MAX_KERNEL_SIZE 512
+static inline uint64_t plutofilter__noise_row(uint32_t seed, uint32_t frame, int y)
+{
+    const uint64_t key = ((uint64_t)seed << 32) | frame;
+    return plutofilter__splitmix64(key + plutofilter__splitmix64((uint64_t)y * PLUTOFILTER_SPLITMIX_GAMMA));
+}
 
-void plutofilter_gaussian_blur(plutofilter_surface_t in, plutofilter_surface_t out, float std_deviation_x, float std_deviation_y)
+static inline uint64_t plutofilter__noise_at(uint64_t row, int x)
+{
+    return plutofilter__splitmix64(row + (uint64_t)(x + 1) * PLUTOFILTER_SPLITMIX_GAMMA);
+}
+
+void plutofilter_noise(plutofilter_surface_t out, uint32_t seed, uint32_t frame, int monochrome)
+{
+    for(int y = 0; y < out.height; y++) {
+        const uint64_t row = plutofilter__noise_row(seed, frame, y);
+        for(int x = 0; x < out.width; x++) {
+            const uint64_t bits = plutofilter__noise_at(row, x);
+            const uint32_t r = bits & 0xFF;
+            const uint32_t g = monochrome ? r : (bits >> 8) & 0xFF;
+            const uint32_t b = monochrome ? r : (bits >> 16) & 0xFF;
+            PLUTOFILTER_STORE_PIXEL(out, x, y, r, g, b, 255);
+        }
+    }
+}
+
+// The sum of two random bytes, centered on zero, in [-255, 255].
+#define PLUTOFILTER_GRAIN(bits, shift) ((int)(((bits) >> (shift)) & 0xFF) + (int)(((bits) >> ((shift) + 8)) & 0xFF) - 255)
+
+void plutofilter_film_grain(plutofilter_surface_t in, plutofilter_surface_t out, float amount, uint32_t seed, uint32_t frame, int monochrome)
 {
     PLUTOFILTER_OVERLAP_SURFACE(in, out);
 
-    int kernel_width = plutofilter__calc_kernel_size(std_deviation_x);
-    int kernel_height = plutofilter__calc_kernel_size(std_deviation_y);
-    if(kernel_width <= 0 && kernel_height <= 0) {
-        int size = out.width * out.height;
-        for(int i = 0; i < size; i++)
-            out.pixels[i] = in.pixels[i];
+    const float scale = PLUTOFILTER_CLAMP(amount, 0.f, 1.f) / 255.f;
+    for(int y = 0; y < out.height; y++) {
+        const uint64_t row = plutofilter__noise_row(seed, frame, y);
+        for(int x = 0; x < out.width; x++) {
+            PLUTOFILTER_INIT_LOAD_PIXEL(in, x, y, r, g, b, a);
+            const uint64_t bits = plutofilter__noise_at(row, x);
+            const float strength = scale * a;
+            const int grain_r = (int)(PLUTOFILTER_GRAIN(bits, 0) * strength);
+            const int grain_g = monochrome ? grain_r : (int)(PLUTOFILTER_GRAIN(bits, 16) * strength);
+            const int grain_b = monochrome ? grain_r : (int)(PLUTOFILTER_GRAIN(bits, 32) * strength);
+
+            r = PLUTOFILTER_CLAMP((int)r + grain_r, 0, (int)a);
+            g = PLUTOFILTER_CLAMP((int)g + grain_g, 0, (int)a);
+            b = PLUTOFILTER_CLAMP((int)b + grain_b, 0, (int)a);
+            PLUTOFILTER_STORE_PIXEL(out, x, y, r, g, b, a);
+        }
+    }
+}
+
+void plutofilter_gradient_ramp(uint32_t ramp[256], const uint32_t* colors, int count)
+{
+    if(count <= 0) {
+        memset(ramp, 0, 256 * sizeof(uint32_t));
         return;
     }
 
-    if(kernel_width > PLUTOFILTER_MAX_KERNEL_SIZE)
-        kernel_width = PLUTOFILTER_MAX_KERNEL_SIZE;
-    if(kernel_height > PLUTOFILTER_MAX_KERNEL_SIZE) {
-        kernel_height = PLUTOFILTER_MAX_KERNEL_SIZE;
+    for(int i = 0; i < 256; i++) {
+        const int position = i * (count - 1);
+        const int stop = position / 255;
+        const uint32_t t = position % 255;
+
+        const uint32_t from = colors[stop];
+        const uint32_t to = t ? colors[stop + 1] : from;
+
+        uint32_t r0 = PLUTOFILTER_RED(from), g0 = PLUTOFILTER_GREEN(from), b0 = PLUTOFILTER_BLUE(from), a0 = PLUTOFILTER_ALPHA(from);
+        uint32_t r1 = PLUTOFILTER_RED(to), g1 = PLUTOFILTER_GREEN(to), b1 = PLUTOFILTER_BLUE(to), a1 = PLUTOFILTER_ALPHA(to);
+        PLUTOFILTER_PREMULTIPLY_PIXEL(r0, g0, b0, a0);
+        PLUTOFILTER_PREMULTIPLY_PIXEL(r1, g1, b1, a1);
+
+        const uint32_t r = (r0 * (255 - t) + r1 * t + 127) / 255;
+        const uint32_t g = (g0 * (255 - t) + g1 * t + 127) / 255;
+        const uint32_t b = (b0 * (255 - t) + b1 * t + 127) / 255;
+        const uint32_t a = (a0 * (255 - t) + a1 * t + 127) / 255;
+        ramp[i] = PLUTOFILTER_PACK_PIXEL(r, g, b, a);
     }
+}
 
-    uint32_t intermediate[PLUTOFILTER_MAX_KERNEL_SIZE];
+void plutofilter_gradient_map(plutofilter_surface_t in, plutofilter_surface_t out, const uint32_t ramp[256])
+{
+    PLUTOFILTER_OVERLAP_SURFACE(in, out);
 
-    plutofilter__box_blur(in, out, intermediate, kernel_width, kernel_height);
-    plutofilter__box_blur(out, out, intermediate, kernel_width, kernel_height);
-    plutofilter__box_blur(out, out, intermediate, kernel_width, kernel_height);
+    for(int y = 0; y < out.height; y++) {
+        const uint32_t* src = in.pixels + y * in.stride;
+        uint32_t* dst = out.pixels + y * out.stride;
+        for(int x = 0; x < out.width; x++) {
+            const uint32_t a = PLUTOFILTER_ALPHA(src[x]);
+            const uint32_t luminance = plutofilter__luminance(src[x]);
+            if(a == 255) {
+                dst[x] = ramp[luminance];
+                continue;
+            }
+
+            if(a == 0) {
+                dst[x] = 0;
+                continue;
+            }
+
+            // Scale all four channels of the ramp color by alpha, two channels per multiply.
+            const uint32_t color = ramp[PLUTOFILTER_MIN(255 * luminance / a, 255)];
+            const uint32_t rb = (((color & 0x00FF00FF) * (a + 1)) >> 8) & 0x00FF00FF;
+            const uint32_t ag = (((color >> 8) & 0x00FF00FF) * (a + 1)) & 0xFF00FF00;
+            dst[x] = ag | rb;
+        }
+    }
 }
 
 static inline int plutofilter__div255(int x)